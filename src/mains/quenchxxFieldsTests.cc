@@ -0,0 +1,576 @@
+/*
+ * (C) Copyright 2025 Meteorologisk Institutt
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "atlas/array.h"
+#include "atlas/field.h"
+#include "atlas/functionspace.h"
+
+#include "eckit/config/LocalConfiguration.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/mpi/Comm.h"
+#include "eckit/serialisation/MemoryStream.h"
+
+#include "oops/runs/Application.h"
+#include "oops/runs/Run.h"
+#include "oops/util/DateTime.h"
+#include "oops/util/Duration.h"
+#include "oops/util/Logger.h"
+
+#include "quenchxx/EnsembleFields.h"
+#include "quenchxx/Fields.h"
+#include "quenchxx/Geometry.h"
+#include "quenchxx/GeoVaLs.h"
+#include "quenchxx/Increment.h"
+#include "quenchxx/Interpolation.h"
+#include "quenchxx/InterpolationRegistry.h"
+#include "quenchxx/Locations.h"
+#include "quenchxx/ObsSpace.h"
+#include "quenchxx/SimdKernels.h"
+#include "quenchxx/VariablesSwitch.h"
+
+namespace quenchxx {
+
+// -----------------------------------------------------------------------------
+/// Self-checking tests of the Fields features: each check prints a pass/fail line on the test
+/// channel, so that references do not depend on the MPI decomposition or on the instruction set.
+
+class FieldsTests : public oops::Application {
+ public:
+  int execute(const eckit::Configuration & config) const override {
+    // Geometry, variables and date
+    const Geometry geom(eckit::LocalConfiguration(config, "geometry"));
+    const varns::Variables vars(config.getStringVector("variables"));
+    const util::DateTime date(config.getString("date"));
+
+    // Dirac points survive the lazy zero
+    testDirac(geom, vars, date, eckit::LocalConfiguration(config, "dirac"));
+
+    // Copy-on-write sharing
+    testSharing(geom, vars, date);
+
+    // Kernels reproducibility
+    testKernels();
+
+    // Linear algebra and move operations
+    testAlgebra(geom, vars, date);
+
+    // Ensemble storage
+    testEnsemble(geom, vars, date);
+
+    // Stream round trip
+    testStream(geom, vars, date);
+
+    // Single precision read
+    testSinglePrecisionRead(config, vars, date);
+
+#ifdef ECSABER
+    // Observation interpolations
+    testObservations(config, geom, vars, date);
+
+    // Sparse operator adjoint with target ghost points
+    testGhostedAdjoint(config, vars);
+#endif
+
+    return 0;
+  }
+
+ private:
+  std::string appname() const override
+    {return "quenchxx::FieldsTests";}
+
+  // Print and check a test result
+  void check(const std::string & name,
+             const bool passed) const {
+    oops::Log::test() << name << ": " << (passed ? "passed" : "failed") << std::endl;
+    if (!passed) {
+      throw eckit::Exception(name + " failed", Here());
+    }
+  }
+
+  // Relative closeness
+  bool close(const double & a,
+             const double & b,
+             const double & tol = 1.0e-12) const {
+    return std::abs(a-b) <= tol*std::max(std::abs(a), std::abs(b));
+  }
+
+  // Relative difference between fields (exactly zero for identical values)
+  double difference(const Fields & fld1,
+                    const Fields & fld2) const {
+    Fields fldDiff(fld1);
+    fldDiff.diff(fld1, fld2);
+    const double norm = fld1.dot_product_with(fld1);
+    const double normDiff = fldDiff.dot_product_with(fldDiff);
+    return norm > 0.0 ? std::sqrt(normDiff/norm) : std::sqrt(normDiff);
+  }
+
+  void testDirac(const Geometry & geom,
+                 const varns::Variables & vars,
+                 const util::DateTime & date,
+                 const eckit::Configuration & config) const {
+    const double ndir = static_cast<double>(config.getDoubleVector("lon").size());
+
+    // Dirac on lazily zeroed fields
+    Fields fld(geom, vars, date);
+    fld.zero();
+    fld.dirac(config);
+    check("Dirac points kept after lazy zero", close(fld.dot_product_with(fld), ndir));
+
+    // Dirac on a copy sharing its buffers with the source
+    Fields fldShared(fld);
+    fldShared.dirac(config);
+    check("Dirac points on shared fields", close(fldShared.dot_product_with(fldShared), ndir)
+      && close(fld.dot_product_with(fld), ndir));
+
+    // Direct write through the fieldset after a lazy zero, at the first owned active point of
+    // each task (if any)
+    fld.zero();
+    atlas::Field field = fld.fieldSet()[vars[0].name()];
+    auto view = atlas::array::make_view<double, 2>(field);
+    const MaskSegments & segments = geom.gmaskOwnedSegments(geom.groupIndex(vars[0].name()));
+    double expected = 0.0;
+    if (!segments.empty()) {
+      const size_t jj = segments[0][0];
+      view(jj/field.shape(1), jj%field.shape(1)) = 1.0;
+      expected = 1.0;
+    }
+    geom.getComm().allReduceInPlace(expected, eckit::mpi::sum());
+    check("Direct write kept after lazy zero", close(fld.dot_product_with(fld), expected));
+  }
+
+  void testSharing(const Geometry & geom,
+                   const varns::Variables & vars,
+                   const util::DateTime & date) const {
+    // Copy made after an export does not alias the exported fields
+    Fields fld(geom, vars, date);
+    fld.constantValue(1.0);
+    const double dp = fld.dot_product_with(fld);
+    atlas::FieldSet fset;
+    fld.toFieldSet(fset);
+    const Fields fldCopy(fld);
+    for (auto field : fset) {
+      auto view = atlas::array::make_view<double, 2>(field);
+      view.assign(2.0);
+    }
+    check("Copy independent of exported fields", close(fldCopy.dot_product_with(fldCopy), dp));
+
+    // Metadata of a shared copy
+    Fields fldShared(fldCopy);
+    fldShared.fieldSet()[vars[0].name()].metadata().set("interp_type", "nearest");
+    check("Metadata independent of shared copies",
+      fldCopy.fieldSet()[vars[0].name()].metadata().getString("interp_type") == "default");
+
+    // Copy assignment into exclusive buffers keeps them
+    Fields dx(geom, vars, date);
+    dx.constantValue(1.0);
+    const Fields & dxConst = dx;
+    const double * data = atlas::array::make_view<double, 2>(
+      dxConst.fieldSet()[vars[0].name()]).data();
+    dx = fldCopy;
+    dx.axpy(1.0, fldCopy);
+    check("Copy assignment reuses exclusive buffers", (atlas::array::make_view<double, 2>(
+      dxConst.fieldSet()[vars[0].name()]).data() == data)
+      && close(dx.dot_product_with(dx), 4.0*dp));
+  }
+
+  void testKernels() const {
+    // Segment lengths covering all remainders
+    bool identical = true;
+    const std::string isaDefault = kernelsIsa();
+    for (size_t n = 0; n < 40; ++n) {
+      std::vector<double> x(n);
+      std::vector<double> y(n);
+      for (size_t j = 0; j < n; ++j) {
+        x[j] = std::sin(1.3*static_cast<double>(j)+0.1)*1.0e3;
+        y[j] = std::cos(0.7*static_cast<double>(j))/3.0;
+      }
+
+      // Scalar references
+      setKernelsIsa("scalar");
+      const double dotRef = kernelDot(n, x.data(), y.data());
+      std::vector<double> axpyRef(y);
+      kernelAxpy(n, 0.1234567, x.data(), axpyRef.data());
+
+      // Bitwise comparison for each supported instruction set
+      for (const std::string isa : {"sse4", "avx2", "avx512"}) {
+        try {
+          setKernelsIsa(isa);
+        } catch (const eckit::UserError &) {
+          continue;
+        }
+        std::vector<double> axpy(y);
+        kernelAxpy(n, 0.1234567, x.data(), axpy.data());
+        identical = identical && (kernelDot(n, x.data(), y.data()) == dotRef) && (axpy == axpyRef);
+      }
+    }
+    setKernelsIsa(isaDefault);
+    check("Kernels results independent of the instruction set", identical);
+  }
+
+  void testAlgebra(const Geometry & geom,
+                   const varns::Variables & vars,
+                   const util::DateTime & date) const {
+    // Test fields
+    Fields x(geom, vars, date);
+    x.random();
+    Fields y(x);
+    y.schur_product_with(x);
+    Fields z(geom, vars, date);
+    z.constantValue(0.7);
+
+    // axpby against scaling and axpy
+    Fields fld(x);
+    fld.axpby(0.3, -1.7, y);
+    Fields ref(x);
+    ref *= 0.3;
+    ref.axpy(-1.7, y);
+    check("axpby consistent with scaling and axpy", difference(fld, ref) <= 1.0e-12);
+
+    // Linear combination against scaling and axpy
+    fld.linearCombination({0.3, -1.7, 2.0}, {&x, &y, &z});
+    ref.axpy(2.0, z);
+    check("linearCombination consistent with axpy", difference(fld, ref) <= 1.0e-12);
+
+    // Batched dot products against single dot products
+    const std::vector<double> dps = x.dot_products_with({&x, &y, &z});
+    check("dot_products_with consistent with dot_product_with", (dps.size() == 3)
+      && close(dps[0], x.dot_product_with(x)) && close(dps[1], x.dot_product_with(y))
+      && close(dps[2], x.dot_product_with(z)) && x.dot_products_with({}).empty());
+
+    // Move constructor and move assignment
+    Fields src(ref);
+    Fields moved(std::move(src));
+    Fields movedAssigned(geom, vars, date);
+    movedAssigned = std::move(moved);
+    check("Move operations keep values", difference(movedAssigned, ref) == 0.0);
+  }
+
+  void testEnsemble(const Geometry & geom,
+                    const varns::Variables & vars,
+                    const util::DateTime & date) const {
+    // Members
+    const size_t nmembers = 3;
+    Fields x(geom, vars, date);
+    x.random();
+    std::vector<Fields> members;
+    members.reserve(nmembers);
+    for (size_t jm = 0; jm < nmembers; ++jm) {
+      Fields member(x);
+      member *= static_cast<double>(jm+1);
+      Fields offset(geom, vars, date);
+      offset.constantValue(0.5*static_cast<double>(jm));
+      member += offset;
+      members.push_back(member);
+    }
+
+    bool roundTrip = true;
+    bool meanAndPerts = true;
+    for (const bool memberInnermost : {false, true}) {
+      // Copy members in and out
+      EnsembleFields ens(geom, vars, date, nmembers, memberInnermost);
+      for (size_t jm = 0; jm < nmembers; ++jm) {
+        ens.setMember(jm, members[jm]);
+      }
+      for (size_t jm = 0; jm < nmembers; ++jm) {
+        Fields member(geom, vars, date);
+        ens.getMember(jm, member);
+        roundTrip = roundTrip && (difference(member, members[jm]) == 0.0);
+      }
+
+      // Mean and perturbations against Fields
+      Fields mean(geom, vars, date);
+      ens.ensembleMeanAndPerturbations(mean);
+      std::vector<Fields> perts(members);
+      std::vector<Fields*> pertsPtr;
+      for (auto & pert : perts) {
+        pertsPtr.push_back(&pert);
+      }
+      Fields meanRef(geom, vars, date);
+      meanRef.ensembleMeanAndPerturbations(pertsPtr);
+      meanAndPerts = meanAndPerts && (difference(mean, meanRef) <= 1.0e-12);
+      for (size_t jm = 0; jm < nmembers; ++jm) {
+        Fields pert(geom, vars, date);
+        ens.getMember(jm, pert);
+        meanAndPerts = meanAndPerts && (difference(pert, perts[jm]) <= 1.0e-12);
+      }
+    }
+    check("Ensemble members round trip", roundTrip);
+    check("Ensemble mean and perturbations consistent with Fields", meanAndPerts);
+
+    // Member view sharing the ensemble storage
+    std::unique_ptr<EnsembleFields> ens(new EnsembleFields(geom, vars, date, nmembers));
+    ens->setMember(1, members[1]);
+    Fields view(*ens, 1);
+    const bool shared = (difference(view, members[1]) == 0.0);
+
+    // Replacing operation written into the member block
+    Fields other(members[2]);
+    view = std::move(other);
+    Fields member(geom, vars, date);
+    ens->getMember(1, member);
+    const bool written = (difference(member, members[2]) == 0.0);
+
+    // Storage kept alive by the view
+    ens.reset();
+    const bool alive = (difference(view, members[2]) == 0.0);
+    check("Ensemble member views", shared && written && alive);
+  }
+
+  void testStream(const Geometry & geom,
+                  const varns::Variables & vars,
+                  const util::DateTime & date) const {
+    // Write to a memory stream
+    Fields x(geom, vars, date);
+    x.random();
+    eckit::Buffer buffer(x.serialSize()*sizeof(double)+4096);
+    {
+      eckit::MemoryStream out(buffer);
+      out << x;
+    }
+
+    // Read back
+    const eckit::Buffer & constBuffer = buffer;
+    eckit::MemoryStream in(constBuffer);
+    Fields y(geom, vars, date);
+    in >> y;
+    check("Stream round trip", difference(y, x) == 0.0);
+  }
+
+  void testSinglePrecisionRead(const eckit::Configuration & config,
+                               const varns::Variables & vars,
+                               const util::DateTime & date) const {
+    // Geometry with single precision storage
+    eckit::LocalConfiguration geomConfig(config, "geometry");
+    geomConfig.set("single precision fields", true);
+    const Geometry geom(geomConfig);
+
+    // Write and read back (float values are exactly representable in the double precision file),
+    // one file per number of tasks for concurrent tests
+    eckit::LocalConfiguration fileConfig(config, "single precision file");
+    fileConfig.set("filepath", fileConfig.getString("filepath") + "_np"
+      + std::to_string(geom.getComm().size()));
+    Fields x(geom, vars, date);
+    x.random();
+    x.write(fileConfig);
+    Fields y(geom, vars, date);
+    y.read(fileConfig);
+    check("Single precision read round trip", difference(y, x) == 0.0);
+  }
+
+#ifdef ECSABER
+  // Geometry configuration with a regional interpolation
+  eckit::LocalConfiguration regionalGeometry(const eckit::Configuration & config,
+                                             const bool sparse,
+                                             const bool reuse) const {
+    eckit::LocalConfiguration geomConfig(config, "geometry");
+    eckit::LocalConfiguration interpConfig;
+    interpConfig.set("interpolation type", "regional");
+    interpConfig.set("sparse operator", sparse);
+    interpConfig.set("reuse observation stencils", reuse);
+    geomConfig.set("interpolation", interpConfig);
+    return geomConfig;
+  }
+
+  // Relative difference between GeoVaLs (exactly zero for identical values)
+  double difference(const GeoVaLs & gv1,
+                    const GeoVaLs & gv2,
+                    const eckit::mpi::Comm & comm) const {
+    std::vector<double> zz(2, 0.0);
+    for (const auto & field : gv1.fieldSet()) {
+      const auto view1 = atlas::array::make_view<double, 2>(field);
+      const auto view2 = atlas::array::make_view<double, 2>(gv2.fieldSet()[field.name()]);
+      for (atlas::idx_t jo = 0; jo < field.shape(0); ++jo) {
+        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
+          zz[0] += view1(jo, jlevel)*view1(jo, jlevel);
+          zz[1] += (view1(jo, jlevel)-view2(jo, jlevel))*(view1(jo, jlevel)-view2(jo, jlevel));
+        }
+      }
+    }
+    comm.allReduceInPlace(zz.begin(), zz.end(), eckit::mpi::sum());
+    return zz[0] > 0.0 ? std::sqrt(zz[1]/zz[0]) : std::sqrt(zz[1]);
+  }
+
+  void testObservations(const eckit::Configuration & config,
+                        const Geometry & geom,
+                        const varns::Variables & vars,
+                        const util::DateTime & date) const {
+    // Observations at the same locations in two time slots (the observation space needs the
+    // unstructured interpolation of the default geometry)
+    const eckit::LocalConfiguration obsConfig(config, "observations");
+    const util::DateTime bgn = date-util::Duration("PT1H");
+    const util::DateTime end = date+util::Duration("PT1H");
+    ObsSpace obsSpace(obsConfig, geom, bgn, end);
+    obsSpace.generateDistribution(eckit::LocalConfiguration(obsConfig, "generate"));
+    const Locations locs(obsSpace, bgn, end);
+    const Locations locsSlot(obsSpace, end, end);
+    const Increment dx(geom, vars, date);
+
+    // Geometries with regional interpolations
+    const Geometry geomBackend(regionalGeometry(config, false, false));
+    const Geometry geomSparse(regionalGeometry(config, true, false));
+    const Geometry geomReuse(regionalGeometry(config, false, true));
+
+    // Adjoint of the horizontal and CSR vertical interpolations
+    bool adjoint = true;
+    for (const Geometry * geomTest : {&geom, &geomSparse}) {
+      InterpolationRegistry::instance().clear();
+      Fields x(*geomTest, vars, date);
+      x.random();
+      GeoVaLs hx(obsSpace, vars, dx, bgn, end);
+      x.interpolate(locs, hx);
+      GeoVaLs y(obsSpace, vars, dx, bgn, end);
+      for (auto field : y.fieldSet()) {
+        auto view = atlas::array::make_view<double, 2>(field);
+        for (atlas::idx_t jo = 0; jo < field.shape(0); ++jo) {
+          for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
+            view(jo, jlevel) = 1.0+0.1*static_cast<double>(jo+jlevel);
+          }
+        }
+      }
+      Fields hty(*geomTest, vars, date);
+      hty.zero();
+      hty.interpolateAD(locs, y);
+      adjoint = adjoint && close(hx.dot_product_with(y), x.dot_product_with(hty));
+    }
+    check("Observation interpolation adjoint", adjoint);
+
+    // Sparse operator against the atlas backend (same random values on identical grids)
+    InterpolationRegistry::instance().clear();
+    Fields xBackend(geomBackend, vars, date);
+    xBackend.random();
+    GeoVaLs gvBackend(obsSpace, vars, dx, bgn, end);
+    xBackend.interpolate(locs, gvBackend);
+    InterpolationRegistry::instance().clear();
+    Fields xSparse(geomSparse, vars, date);
+    xSparse.random();
+    GeoVaLs gvSparse(obsSpace, vars, dx, bgn, end);
+    xSparse.interpolate(locs, gvSparse);
+    check("Sparse operator consistent with the backend",
+      difference(gvBackend, gvSparse, geom.getComm()) <= 1.0e-12);
+
+    // Stencils of the second slot reused from the whole window
+    InterpolationRegistry::instance().clear();
+    Fields xReuse(geomReuse, vars, date);
+    xReuse.random();
+    GeoVaLs gvWindow(obsSpace, vars, dx, bgn, end);
+    xReuse.interpolate(locs, gvWindow);
+    GeoVaLs gvReuse(obsSpace, vars, dx, end, end);
+    xReuse.interpolate(locsSlot, gvReuse);
+    bool reused = false;
+    const std::string srcUid = geomReuse.grid().uid() + "_" + geomReuse.partitioner().type();
+    for (const auto & candidate : InterpolationRegistry::instance().candidates(srcUid)) {
+      reused = reused || static_cast<bool>(candidate->parent());
+    }
+
+    // Fresh stencils
+    InterpolationRegistry::instance().clear();
+    Fields xFresh(geomBackend, vars, date);
+    xFresh.random();
+    GeoVaLs gvFresh(obsSpace, vars, dx, end, end);
+    xFresh.interpolate(locsSlot, gvFresh);
+    check("Stencil reuse consistent with fresh stencils", reused
+      && (difference(gvReuse, gvFresh, geom.getComm()) <= 1.0e-12));
+
+    // Memory budget exceeded: all tasks evict the same entries (inconsistent lookups would hang
+    // in the collective setup of the next interpolation)
+    InterpolationRegistry & registry = InterpolationRegistry::instance();
+    registry.clear();
+    const Locations locsFirst(obsSpace, date, date);
+    Fields xBudget(geomBackend, vars, date);
+    xBudget.random();
+    GeoVaLs gvFirst(obsSpace, vars, dx, date, date);
+    xBudget.interpolate(locsFirst, gvFirst);
+    registry.setMaxBytes(registry.bytes());
+    GeoVaLs gvBudget(obsSpace, vars, dx, bgn, end);
+    xBudget.interpolate(locs, gvBudget);
+    xBudget.interpolate(locsFirst, gvFirst);
+    std::vector<size_t> countsMin = {registry.size(), registry.evictions()};
+    std::vector<size_t> countsMax(countsMin);
+    geom.getComm().allReduceInPlace(countsMin.begin(), countsMin.end(), eckit::mpi::min());
+    geom.getComm().allReduceInPlace(countsMax.begin(), countsMax.end(), eckit::mpi::max());
+    check("Registry evictions identical on all tasks", (countsMin == countsMax)
+      && (countsMin[1] > 0));
+    registry.setMaxBytes(0);
+    registry.clear();
+  }
+
+  void testGhostedAdjoint(const eckit::Configuration & config,
+                          const varns::Variables & vars) const {
+    // Grid to grid sparse operator, the target function space having a halo
+    const Geometry geomSparse(regionalGeometry(config, true, false));
+    const atlas::FunctionSpace & fspace = geomSparse.functionSpace();
+    const std::string uid = geomSparse.grid().uid() + "_" + geomSparse.partitioner().type();
+    const Interpolation interpolation(geomSparse, uid, geomSparse.grid(), fspace, uid);
+
+    // Source and target fields, nonzero on target ghost points
+    atlas::FieldSet x;
+    atlas::FieldSet hx;
+    atlas::FieldSet y;
+    atlas::FieldSet hty;
+    for (const auto & var : vars) {
+      const auto options = atlas::option::name(var.name())
+        | atlas::option::levels(geomSparse.levels(var.name()));
+      for (atlas::FieldSet * fset : {&x, &hx, &y, &hty}) {
+        atlas::Field field = fspace.createField<double>(options);
+        field.metadata().set("interp_type", "default");
+        auto view = atlas::array::make_view<double, 2>(field);
+        for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
+          for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
+            view(jnode, jlevel) = (fset == &x) ? 1.0+0.1*static_cast<double>(jnode%7+jlevel)
+              : ((fset == &y) ? 2.0-0.1*static_cast<double>(jnode%5+jlevel) : 0.0);
+          }
+        }
+        field.set_dirty();
+        fset->add(field);
+      }
+    }
+    interpolation.execute(x, hx);
+    interpolation.executeAdjoint(hty, y);
+
+    // Target inner product on all points (ghost points filled by the forward operator), source
+    // inner product on owned points
+    const auto ghostView = atlas::array::make_view<int, 1>(fspace.ghost());
+    std::vector<double> dots(2, 0.0);
+    for (const auto & var : vars) {
+      const auto xView = atlas::array::make_view<double, 2>(x[var.name()]);
+      const auto hxView = atlas::array::make_view<double, 2>(hx[var.name()]);
+      const auto yView = atlas::array::make_view<double, 2>(y[var.name()]);
+      const auto htyView = atlas::array::make_view<double, 2>(hty[var.name()]);
+      for (atlas::idx_t jnode = 0; jnode < xView.shape(0); ++jnode) {
+        for (atlas::idx_t jlevel = 0; jlevel < xView.shape(1); ++jlevel) {
+          dots[0] += hxView(jnode, jlevel)*yView(jnode, jlevel);
+          if (ghostView(jnode) == 0) {
+            dots[1] += xView(jnode, jlevel)*htyView(jnode, jlevel);
+          }
+        }
+      }
+    }
+    geomSparse.getComm().allReduceInPlace(dots.begin(), dots.end(), eckit::mpi::sum());
+    check("Sparse operator adjoint on ghosted targets", close(dots[0], dots[1]));
+  }
+#endif
+};
+
+// -----------------------------------------------------------------------------
+
+}  // namespace quenchxx
+
+int main(int argc, char** argv) {
+  oops::Run run(argc, argv);
+  quenchxx::FieldsTests tests;
+  run.execute(tests);
+  return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * (C) Copyright 2025 Meteorologisk Institutt
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "quenchxx/SimdKernels.h"
+
+// Benchmark of the Fields arithmetic kernels on 137-level columns, for each instruction set
+// supported by the CPU. Usage: quenchxx_kernels_benchmark.x [number of columns] [repetitions]
+
+int main(int argc, char ** argv) {
+  const size_t nlevs = 137;
+  const size_t ncols = argc > 1 ? std::stoul(argv[1]) : 20000;
+  const size_t nrep = argc > 2 ? std::stoul(argv[2]) : 20;
+
+  // Segments of at most 4096 values, as built from the geometry masks
+  const size_t nvals = ncols*nlevs;
+  std::vector<std::pair<size_t, size_t>> segments;
+  for (size_t j0 = 0; j0 < nvals; j0 += 4096) {
+    segments.push_back(std::make_pair(j0, std::min(j0+4096, nvals)));
+  }
+
+  // Data
+  std::vector<double> x(nvals);
+  std::vector<double> y(nvals);
+  for (size_t jj = 0; jj < nvals; ++jj) {
+    x[jj] = std::sin(static_cast<double>(jj));
+    y[jj] = std::cos(static_cast<double>(jj));
+  }
+
+  std::cout << "Kernels benchmark: " << ncols << " columns of " << nlevs << " levels, " << nrep
+            << " repetitions" << std::endl;
+  std::cout << std::setw(8) << "isa" << std::setw(12) << "add" << std::setw(12) << "axpy"
+            << std::setw(12) << "scale" << std::setw(12) << "schur" << std::setw(12) << "dot"
+            << std::setw(12) << "minmax" << "  (ms)" << std::endl;
+
+  double sink = 0.0;
+  for (const std::string isa : {"scalar", "sse4", "avx2", "avx512"}) {
+    try {
+      quenchxx::setKernelsIsa(isa);
+    } catch (...) {
+      std::cout << std::setw(8) << isa << "  not supported" << std::endl;
+      continue;
+    }
+    std::vector<double> times;
+
+    // Time a kernel applied to all segments
+    const auto timeKernel = [&](const auto & kernel) {
+      const auto start = std::chrono::steady_clock::now();
+      for (size_t jrep = 0; jrep < nrep; ++jrep) {
+        for (const auto & seg : segments) {
+          kernel(seg.second-seg.first, seg.first);
+        }
+      }
+      const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now()-start;
+      times.push_back(elapsed.count());
+    };
+
+    timeKernel([&](const size_t n, const size_t j0) {
+      quenchxx::kernelAdd(n, x.data()+j0, y.data()+j0);});
+    timeKernel([&](const size_t n, const size_t j0) {
+      quenchxx::kernelAxpy(n, -0.5, x.data()+j0, y.data()+j0);});
+    timeKernel([&](const size_t n, const size_t j0) {
+      quenchxx::kernelScale(n, 0.999, y.data()+j0);});
+    timeKernel([&](const size_t n, const size_t j0) {
+      quenchxx::kernelSchur(n, x.data()+j0, y.data()+j0);});
+    timeKernel([&](const size_t n, const size_t j0) {
+      sink += quenchxx::kernelDot(n, x.data()+j0, y.data()+j0);});
+    timeKernel([&](const size_t n, const size_t j0) {
+      double zmin = 0.0;
+      double zmax = 0.0;
+      quenchxx::kernelMinMax(n, x.data()+j0, zmin, zmax);
+      sink += zmax-zmin;});
+
+    std::cout << std::setw(8) << quenchxx::kernelsIsa() << std::fixed << std::setprecision(2);
+    for (const auto & time : times) {
+      std::cout << std::setw(12) << time;
+    }
+    std::cout << std::endl;
+  }
+  std::cout << "Checksum: " << sink << std::endl;
+
+  return 0;
+}
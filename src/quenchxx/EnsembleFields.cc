@@ -0,0 +1,329 @@
+/*
+ * (C) Copyright 2025 Meteorologisk Institutt
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "quenchxx/EnsembleFields.h"
+
+#include <algorithm>
+
+#include "atlas/array.h"
+
+#include "eckit/exception/Exceptions.h"
+
+#include "oops/util/Logger.h"
+
+#include "quenchxx/Utilities.h"
+
+namespace quenchxx {
+
+// -----------------------------------------------------------------------------
+
+EnsembleFields::EnsembleFields(const Geometry & geom,
+                               const varns::Variables & vars,
+                               const util::DateTime & time,
+                               const size_t & nmembers,
+                               const bool memberInnermost)
+  : geom_(Geometry::shared(geom)), vars_(vars), time_(time), nmembers_(nmembers),
+  memberInnermost_(memberInnermost) {
+  oops::Log::trace() << classname() << "::EnsembleFields starting" << std::endl;
+
+  // Check number of members
+  ASSERT(nmembers_ > 0);
+
+  // Storage datatype
+  const atlas::array::DataType datatype = geom_->singlePrecision()
+    ? atlas::array::DataType::create<float>() : atlas::array::DataType::create<double>();
+
+  const size_t nnodes = geom_->functionSpace().size();
+  for (auto & var : vars_) {
+    // Set number of levels
+    var.setLevels(geom_->levels(var.name()));
+    const size_t nlevs = var.getLevels();
+
+    // Create storage field
+    atlas::array::ArrayShape shape = memberInnermost_
+      ? atlas::array::make_shape(nnodes, nlevs, nmembers_)
+      : atlas::array::make_shape(nmembers_, nnodes, nlevs);
+    storage_.push_back(atlas::Field(var.name(), datatype, shape));
+  }
+
+  // Set fields to zero
+  zero();
+
+  oops::Log::trace() << classname() << "::EnsembleFields done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+const atlas::Field & EnsembleFields::storage(const std::string & name) const {
+  return storage_[variableIndex(name)];
+}
+
+// -----------------------------------------------------------------------------
+
+void EnsembleFields::zero() {
+  oops::Log::trace() << classname() << "::zero starting" << std::endl;
+
+  for (auto & field : storage_) {
+    visitFieldStorage(field, [&](auto tag) {
+      using T = decltype(tag);
+      auto view = atlas::array::make_view<T, 3>(field);
+      view.assign(0.0);
+    });
+  }
+
+  oops::Log::trace() << classname() << "::zero done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+atlas::FieldSet EnsembleFields::memberFieldSet(const size_t & member) {
+  oops::Log::trace() << classname() << "::memberFieldSet starting" << std::endl;
+
+  // Check layout and member index
+  if (memberInnermost_) {
+    throw eckit::UserError("member fieldset cannot be shared with a member-innermost layout",
+      Here());
+  }
+  ASSERT(member < nmembers_);
+
+  atlas::FieldSet fset;
+  for (size_t jvar = 0; jvar < vars_.size(); ++jvar) {
+    atlas::Field & field = storage_[jvar];
+    const size_t nnodes = field.shape(1);
+    const size_t nlevs = field.shape(2);
+    visitFieldStorage(field, [&](auto tag) {
+      using T = decltype(tag);
+      auto view = atlas::array::make_view<T, 3>(field);
+
+      // Wrap member block
+      atlas::Field memberField(vars_[jvar].name(), view.data()+member*nnodes*nlevs,
+        atlas::array::make_shape(nnodes, nlevs));
+      memberField.set_functionspace(geom_->functionSpace());
+      memberField.metadata().set("interp_type", "default");
+      memberField.set_dirty();
+      fset.add(memberField);
+    });
+  }
+
+  oops::Log::trace() << classname() << "::memberFieldSet done" << std::endl;
+  return fset;
+}
+
+// -----------------------------------------------------------------------------
+
+void EnsembleFields::getMember(const size_t & member,
+                               Fields & fields) const {
+  oops::Log::trace() << classname() << "::getMember starting" << std::endl;
+
+  ASSERT(member < nmembers_);
+  atlas::FieldSet & fset = fields.writableFieldSet();
+  for (size_t jvar = 0; jvar < vars_.size(); ++jvar) {
+    const atlas::Field & field = storage_[jvar];
+    atlas::Field memberField = fset[vars_[jvar].name()];
+    visitFieldStorage(field, [&](auto tag) {
+      using T = decltype(tag);
+      const auto view = atlas::array::make_view<const T, 3>(field);
+      auto memberView = atlas::array::make_view<T, 2>(memberField);
+      for (atlas::idx_t jnode = 0; jnode < memberField.shape(0); ++jnode) {
+        for (atlas::idx_t jlevel = 0; jlevel < memberField.shape(1); ++jlevel) {
+          memberView(jnode, jlevel) = memberInnermost_ ? view(jnode, jlevel, member)
+            : view(member, jnode, jlevel);
+        }
+      }
+    });
+    memberField.set_dirty();
+  }
+
+  oops::Log::trace() << classname() << "::getMember done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void EnsembleFields::setMember(const size_t & member,
+                               const Fields & fields) {
+  oops::Log::trace() << classname() << "::setMember starting" << std::endl;
+
+  ASSERT(member < nmembers_);
+  const atlas::FieldSet & fset = fields.fieldSet();
+  for (size_t jvar = 0; jvar < vars_.size(); ++jvar) {
+    atlas::Field & field = storage_[jvar];
+    const atlas::Field memberField = fset[vars_[jvar].name()];
+    visitFieldStorage(field, [&](auto tag) {
+      using T = decltype(tag);
+      auto view = atlas::array::make_view<T, 3>(field);
+      const auto memberView = atlas::array::make_view<const T, 2>(memberField);
+      for (atlas::idx_t jnode = 0; jnode < memberField.shape(0); ++jnode) {
+        for (atlas::idx_t jlevel = 0; jlevel < memberField.shape(1); ++jlevel) {
+          if (memberInnermost_) {
+            view(jnode, jlevel, member) = memberView(jnode, jlevel);
+          } else {
+            view(member, jnode, jlevel) = memberView(jnode, jlevel);
+          }
+        }
+      }
+    });
+  }
+
+  oops::Log::trace() << classname() << "::setMember done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void EnsembleFields::getLocal(const GeometryIterator & geometryIterator,
+                              std::vector<double> & values) const {
+  // Levels range
+  const bool allLevels = (geometryIterator.iteratorDimension() == 2);
+  const size_t jnode = geometryIterator.jnode();
+
+  values.clear();
+  for (const auto & field : storage_) {
+    const size_t nnodes = memberInnermost_ ? field.shape(0) : field.shape(1);
+    const size_t nlevs = memberInnermost_ ? field.shape(1) : field.shape(2);
+    const size_t levelBegin = allLevels ? 0 : geometryIterator.jlevel();
+    const size_t levelEnd = allLevels ? nlevs : geometryIterator.jlevel()+1;
+    visitFieldStorage(field, [&](auto tag) {
+      using T = decltype(tag);
+      const T * data = atlas::array::make_view<const T, 3>(field).data();
+      for (size_t jlevel = levelBegin; jlevel < levelEnd; ++jlevel) {
+        if (memberInnermost_) {
+          // Contiguous members
+          const T * dataPoint = data+(jnode*nlevs+jlevel)*nmembers_;
+          values.insert(values.end(), dataPoint, dataPoint+nmembers_);
+        } else {
+          for (size_t jm = 0; jm < nmembers_; ++jm) {
+            values.push_back(data[(jm*nnodes+jnode)*nlevs+jlevel]);
+          }
+        }
+      }
+    });
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void EnsembleFields::setLocal(const GeometryIterator & geometryIterator,
+                              const std::vector<double> & values) {
+  // Levels range
+  const bool allLevels = (geometryIterator.iteratorDimension() == 2);
+  const size_t jnode = geometryIterator.jnode();
+
+  size_t index = 0;
+  for (auto & field : storage_) {
+    const size_t nnodes = memberInnermost_ ? field.shape(0) : field.shape(1);
+    const size_t nlevs = memberInnermost_ ? field.shape(1) : field.shape(2);
+    const size_t levelBegin = allLevels ? 0 : geometryIterator.jlevel();
+    const size_t levelEnd = allLevels ? nlevs : geometryIterator.jlevel()+1;
+    visitFieldStorage(field, [&](auto tag) {
+      using T = decltype(tag);
+      T * data = atlas::array::make_view<T, 3>(field).data();
+      for (size_t jlevel = levelBegin; jlevel < levelEnd; ++jlevel) {
+        for (size_t jm = 0; jm < nmembers_; ++jm) {
+          const size_t jj = memberInnermost_ ? (jnode*nlevs+jlevel)*nmembers_+jm
+            : (jm*nnodes+jnode)*nlevs+jlevel;
+          ASSERT(index < values.size());
+          data[jj] = values[index];
+          ++index;
+        }
+      }
+    });
+  }
+  ASSERT(index == values.size());
+}
+
+// -----------------------------------------------------------------------------
+
+void EnsembleFields::ensembleMeanAndPerturbations(Fields & mean) {
+  oops::Log::trace() << classname() << "::ensembleMeanAndPerturbations starting" << std::endl;
+
+  const double rnm = 1.0/static_cast<double>(nmembers_);
+  atlas::FieldSet & meanFset = mean.writableFieldSet();
+  for (size_t jvar = 0; jvar < vars_.size(); ++jvar) {
+    atlas::Field & field = storage_[jvar];
+    atlas::Field meanField = meanFset[vars_[jvar].name()];
+    const size_t n = meanField.shape(0)*meanField.shape(1);
+    const MaskSegments & segments = geom_->gmaskSegments(geom_->groupIndex(vars_[jvar].name()));
+    visitFieldStorage(field, [&](auto tag) {
+      using T = decltype(tag);
+      T * data = atlas::array::make_view<T, 3>(field).data();
+      T * dataMean = atlas::array::make_view<T, 2>(meanField).data();
+      if (memberInnermost_) {
+        // Members are contiguous at each point
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+            T * dataPoint = data+jj*nmembers_;
+            double zmean = 0.0;
+            for (size_t jm = 0; jm < nmembers_; ++jm) {
+              zmean += dataPoint[jm];
+            }
+            zmean *= rnm;
+            dataMean[jj] = zmean;
+            for (size_t jm = 0; jm < nmembers_; ++jm) {
+              dataPoint[jm] -= zmean;
+            }
+          }
+        }
+      } else {
+        // Members are contiguous blocks, processed segment by segment
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          const size_t offset = segments[jseg][0];
+          std::vector<double> zmean(segments[jseg][1]-offset, 0.0);
+          for (size_t jm = 0; jm < nmembers_; ++jm) {
+            const T * dataMember = data+jm*n;
+            for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+              zmean[jj-offset] += dataMember[jj];
+            }
+          }
+          for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+            zmean[jj-offset] *= rnm;
+            dataMean[jj] = zmean[jj-offset];
+          }
+          for (size_t jm = 0; jm < nmembers_; ++jm) {
+            T * dataMember = data+jm*n;
+            for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+              dataMember[jj] -= zmean[jj-offset];
+            }
+          }
+        }
+      }
+    });
+    meanField.set_dirty();
+  }
+
+  oops::Log::trace() << classname() << "::ensembleMeanAndPerturbations done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t EnsembleFields::variableIndex(const std::string & name) const {
+  for (size_t jvar = 0; jvar < vars_.size(); ++jvar) {
+    if (vars_[jvar].name() == name) {
+      return jvar;
+    }
+  }
+  throw eckit::Exception("variable " + name + " not found in ensemble fields", Here());
+}
+
+// -----------------------------------------------------------------------------
+
+void EnsembleFields::print(std::ostream & os) const {
+  oops::Log::trace() << classname() << "::print starting" << std::endl;
+
+  os << "Ensemble fields: " << nmembers_ << " members, "
+     << (memberInnermost_ ? "member-innermost" : "member-outermost") << " layout" << std::endl;
+  os << "Valid time: " << time_ << std::endl;
+  for (const auto & var : vars_) {
+    os << "  " << var.name() << ": " << var.getLevels() << " levels" << std::endl;
+  }
+
+  oops::Log::trace() << classname() << "::print done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+}  // namespace quenchxx
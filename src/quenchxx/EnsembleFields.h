@@ -0,0 +1,109 @@
+/*
+ * (C) Copyright 2025 Meteorologisk Institutt
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "atlas/field.h"
+
+#include "oops/util/DateTime.h"
+#include "oops/util/ObjectCounter.h"
+#include "oops/util/Printable.h"
+
+#include "quenchxx/Fields.h"
+#include "quenchxx/Geometry.h"
+#include "quenchxx/GeometryIterator.h"
+#include "quenchxx/VariablesSwitch.h"
+
+namespace quenchxx {
+
+// -----------------------------------------------------------------------------
+/// Ensemble of fields stored contiguously, one storage field per variable:
+/// - member-outermost layout: (member, node, level), members are contiguous blocks that can be
+///   shared without copy by Fields/Increment views,
+/// - member-innermost layout: (node, level, member), all members at a grid point are contiguous.
+
+class EnsembleFields : public util::Printable,
+                       private util::ObjectCounter<EnsembleFields> {
+ public:
+  static const std::string classname()
+    {return "quenchxx::EnsembleFields";}
+
+  // Constructor
+  EnsembleFields(const Geometry &,
+                 const varns::Variables &,
+                 const util::DateTime &,
+                 const size_t &,
+                 const bool memberInnermost = false);
+
+  // Accessors
+  size_t size() const
+    {return nmembers_;}
+  bool memberInnermost() const
+    {return memberInnermost_;}
+  std::shared_ptr<const Geometry> geometry() const
+    {return geom_;}
+  const varns::Variables & variables() const
+    {return vars_;}
+  const util::DateTime & time() const
+    {return time_;}
+  const atlas::Field & storage(const std::string &) const;
+
+  // Basic operators
+  void zero();
+
+  // Fieldset sharing the storage of a member (member-outermost layout only)
+  atlas::FieldSet memberFieldSet(const size_t &);
+
+  // Copy a member from/to Fields (any layout)
+  void getMember(const size_t &,
+                 Fields &) const;
+  void setMember(const size_t &,
+                 const Fields &);
+
+  // Values of all members at a grid point, ordered by variable, level and member
+  void getLocal(const GeometryIterator &,
+                std::vector<double> &) const;
+  void setLocal(const GeometryIterator &,
+                const std::vector<double> &);
+
+  // Compute ensemble mean and remove it from members
+  void ensembleMeanAndPerturbations(Fields &);
+
+ private:
+  // Print
+  void print(std::ostream &) const;
+
+  // Index of a variable
+  size_t variableIndex(const std::string &) const;
+
+  // Geometry
+  std::shared_ptr<const Geometry> geom_;
+
+  // Variables
+  varns::Variables vars_;
+
+  // Time
+  util::DateTime time_;
+
+  // Number of members
+  size_t nmembers_;
+
+  // Layout
+  bool memberInnermost_;
+
+  // Storage fields (one per variable)
+  std::vector<atlas::Field> storage_;
+};
+
+// -----------------------------------------------------------------------------
+
+}  // namespace quenchxx
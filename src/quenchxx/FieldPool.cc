@@ -0,0 +1,156 @@
+/*
+ * (C) Copyright 2025 Meteorologisk Institutt
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "quenchxx/FieldPool.h"
+
+#include <algorithm>
+
+#include "eckit/thread/AutoLock.h"
+
+#include "oops/util/Logger.h"
+
+namespace quenchxx {
+
+// -----------------------------------------------------------------------------
+
+FieldPool::FieldPool(const atlas::FunctionSpace & functionSpace,
+                     const size_t & maxBytes)
+  : functionSpace_(functionSpace), maxBytes_(maxBytes), fields_(), metadata_(),
+  hits_(0), misses_(0), bytes_(0), peakBytes_(0) {
+  oops::Log::trace() << classname() << "::FieldPool" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+FieldPool::~FieldPool() {
+  oops::Log::trace() << classname() << "::~FieldPool starting" << std::endl;
+
+  // Print statistics
+  if (hits_+misses_ > 0) {
+    this->print(oops::Log::info());
+  }
+
+  oops::Log::trace() << classname() << "::~FieldPool done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+atlas::Field FieldPool::acquire(const std::string & name,
+                                const size_t & levels,
+                                const atlas::array::DataType & datatype) {
+  oops::Log::trace() << classname() << "::acquire starting" << std::endl;
+
+  atlas::Field field;
+  const std::pair<int, size_t> key(datatype.kind(), levels);
+  {
+    eckit::AutoLock<eckit::Mutex> lock(mutex_);
+
+    // Look for an available field
+    auto it = fields_.find(key);
+    if (it != fields_.end() && !it->second.empty()) {
+      field = it->second.back();
+      it->second.pop_back();
+      bytes_ -= field.bytes();
+      ++hits_;
+
+      // Reset metadata and dirty flag left by the previous owner
+      field.metadata() = metadata_.at(key);
+    } else {
+      ++misses_;
+    }
+  }
+
+  if (field) {
+    // Recycled field
+    field.rename(name);
+    field.set_dirty();
+  } else {
+    // New field
+    field = functionSpace_.createField(atlas::option::name(name)
+      | atlas::option::levels(levels) | atlas::option::datatype(datatype));
+
+    // Keep the metadata of a new field
+    eckit::AutoLock<eckit::Mutex> lock(mutex_);
+    if (metadata_.find(key) == metadata_.end()) {
+      metadata_[key] = field.metadata();
+    }
+  }
+
+  oops::Log::trace() << classname() << "::acquire done" << std::endl;
+  return field;
+}
+
+// -----------------------------------------------------------------------------
+
+void FieldPool::release(const atlas::Field & field) {
+  oops::Log::trace() << classname() << "::release starting" << std::endl;
+
+  // Only keep unshared rank-2 fields defined on the pool function space, with a known new field
+  // metadata to reset them
+  if (field && field.get()->owners() == 1 && field.rank() == 2
+    && field.functionspace().get() == functionSpace_.get()) {
+    eckit::AutoLock<eckit::Mutex> lock(mutex_);
+    const std::pair<int, size_t> key(field.datatype().kind(), field.shape(1));
+    if (bytes_+field.bytes() <= maxBytes_ && metadata_.find(key) != metadata_.end()) {
+      fields_[key].push_back(field);
+      bytes_ += field.bytes();
+      peakBytes_ = std::max(peakBytes_, bytes_);
+    }
+  }
+
+  oops::Log::trace() << classname() << "::release done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t FieldPool::hits() const {
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  return hits_;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t FieldPool::misses() const {
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  return misses_;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t FieldPool::bytes() const {
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  return bytes_;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t FieldPool::peakBytes() const {
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  return peakBytes_;
+}
+
+// -----------------------------------------------------------------------------
+
+void FieldPool::print(std::ostream & os) const {
+  oops::Log::trace() << classname() << "::print starting" << std::endl;
+
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  std::string prefix;
+  if (os.rdbuf() == oops::Log::info().rdbuf()) {
+    prefix = "Info     : ";
+  }
+  os << prefix << "Field pool statistics:" << std::endl;
+  os << prefix << "- hits: " << hits_ << std::endl;
+  os << prefix << "- misses: " << misses_ << std::endl;
+  os << prefix << "- peak size: " << peakBytes_ << " bytes" << std::endl;
+
+  oops::Log::trace() << classname() << "::print done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+}  // namespace quenchxx
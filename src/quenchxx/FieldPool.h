@@ -0,0 +1,84 @@
+/*
+ * (C) Copyright 2025 Meteorologisk Institutt
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "atlas/field.h"
+#include "atlas/functionspace.h"
+#include "atlas/util/Metadata.h"
+
+#include "eckit/thread/Mutex.h"
+
+#include "oops/util/ObjectCounter.h"
+#include "oops/util/Printable.h"
+
+namespace quenchxx {
+
+// -----------------------------------------------------------------------------
+/// Pool of field buffers recycled on a given function space
+
+class FieldPool : public util::Printable,
+                  private util::ObjectCounter<FieldPool> {
+ public:
+  static const std::string classname()
+    {return "quenchxx::FieldPool";}
+
+  // Constructor/destructor
+  FieldPool(const atlas::FunctionSpace &,
+            const size_t &);
+  ~FieldPool();
+
+  // Get a field with the given name, number of levels and datatype (content is undefined,
+  // metadata and dirty flag are those of a new field)
+  atlas::Field acquire(const std::string &,
+                       const size_t &,
+                       const atlas::array::DataType & = atlas::array::DataType::create<double>());
+
+  // Give a field back to the pool, if it is not shared and if the pool is not full
+  void release(const atlas::Field &);
+
+  // Statistics
+  size_t hits() const;
+  size_t misses() const;
+  size_t bytes() const;
+  size_t peakBytes() const;
+
+ private:
+  // Print
+  void print(std::ostream &) const;
+
+  // Function space
+  const atlas::FunctionSpace functionSpace_;
+
+  // Maximum pool size (in bytes)
+  const size_t maxBytes_;
+
+  // Available fields, sorted by datatype kind and number of levels
+  std::map<std::pair<int, size_t>, std::vector<atlas::Field>> fields_;
+
+  // Metadata of a new field, restored on recycled fields
+  std::map<std::pair<int, size_t>, atlas::util::Metadata> metadata_;
+
+  // Mutex
+  mutable eckit::Mutex mutex_;
+
+  // Statistics
+  size_t hits_;
+  size_t misses_;
+  size_t bytes_;
+  size_t peakBytes_;
+};
+
+// -----------------------------------------------------------------------------
+
+}  // namespace quenchxx
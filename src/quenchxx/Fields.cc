@@ -33,6 +33,7 @@
 
 #include "eckit/config/Configuration.h"
 #include "eckit/exception/Exceptions.h"
+#include "eckit/log/Channel.h"
 #include "eckit/mpi/Comm.h"
 
 #include "oops/util/FieldSetHelpers.h"
@@ -41,7 +42,11 @@
 #include "oops/util/Logger.h"
 #include "oops/util/Random.h"
 
+#include "quenchxx/EnsembleFields.h"
 #include "quenchxx/Geometry.h"
+#include "quenchxx/InterpolationRegistry.h"
+#include "quenchxx/SimdKernels.h"
+#include "quenchxx/Utilities.h"
 
 #define ERR(e, msg) {std::string s(nc_strerror(e)); \
   throw eckit::Exception(s + " : " + msg, Here());}
@@ -50,20 +55,12 @@ namespace quenchxx {
 
 // -----------------------------------------------------------------------------
 
-static std::vector<quenchxx::Interpolation> interpolationsVector;
-
-// -----------------------------------------------------------------------------
-
-std::vector<quenchxx::Interpolation>& Fields::interpolations() {
-  return interpolationsVector;
-}
-
-// -----------------------------------------------------------------------------
-
 Fields::Fields(const Geometry & geom,
                const varns::Variables & vars,
                const util::DateTime & time)
-  : geom_(new Geometry(geom)), vars_(vars), time_(time) {
+  : geom_(Geometry::shared(geom)), vars_(vars), time_(time),
+    descriptorsValid_(false), storageToken_(std::make_shared<int>(0)), pendingZero_(false),
+    exported_(false), view_(false) {
   oops::Log::trace() << classname() << "::Fields starting" << std::endl;
 
   // Reset ATLAS fieldset
@@ -74,8 +71,7 @@ Fields::Fields(const Geometry & geom,
     var.setLevels(geom_->levels(var.name()));
 
     // Create field
-    atlas::Field field = geom_->functionSpace().createField<double>(
-      atlas::option::name(var.name()) | atlas::option::levels(var.getLevels()));
+    atlas::Field field = createField(var.name(), var.getLevels());
     fset_.add(field);
   }
 
@@ -84,8 +80,9 @@ Fields::Fields(const Geometry & geom,
     field.metadata().set("interp_type", "default");
   }
 
-  // Set fields to zero
-  this->zero();
+  // Set fields to zero (lazily)
+  pendingZero_ = true;
+  fset_.set_dirty(false);
 
   oops::Log::trace() << classname() << "::Fields done" << std::endl;
 }
@@ -94,12 +91,17 @@ Fields::Fields(const Geometry & geom,
 
 Fields::Fields(const Fields & other,
                const Geometry & geom)
-  : geom_(new Geometry(geom)), vars_(other.vars_), time_(other.time_) {
+  : geom_(Geometry::shared(geom)), vars_(other.vars_), time_(other.time_),
+    descriptorsValid_(false), storageToken_(std::make_shared<int>(0)), pendingZero_(false),
+    exported_(false), view_(false) {
   oops::Log::trace() << classname() << "::Fields starting" << std::endl;
 
   // Reset ATLAS fieldset
   fset_ = atlas::FieldSet();
 
+  // Apply pending zero of the source
+  other.materializeZero();
+
   // Check number of levels
   for (const auto & var : vars_) {
     if (geom_->levels(var.name()) != geom.levels(var.name())) {
@@ -111,11 +113,14 @@ Fields::Fields(const Fields & other,
   if (geom_->grid() == other.geom_->grid() && geom_->halo() == other.geom_->halo()) {
     // Copy fieldset
     fset_ = util::copyFieldSet(other.fset_);
+
+    // Convert storage precision if needed
+    convertFieldsPrecision();
   } else {
     // Setup interpolation
     const auto & interpolation = setupGridInterpolation(*other.geom_);
 
-    // Create fieldset
+    // Create fieldset (interpolation works in double precision)
     for (const auto & var : vars_) {
       atlas::Field field = geom_->functionSpace().createField<double>(
         atlas::option::name(var.name()) | atlas::option::levels(var.getLevels()));
@@ -130,11 +135,15 @@ Fields::Fields(const Fields & other,
       }
     }
 
-    // Copy fieldset
-    atlas::FieldSet fset = util::copyFieldSet(other.fset_);
+    // Source fieldset
+    atlas::FieldSet fset = other.interpolationSource(other.fset_.field_names());
 
     // Horizontal interpolation
     interpolation->execute(fset, fset_);
+    other.releaseInterpolationSource(fset);
+
+    // Convert storage precision if needed
+    convertFieldsPrecision();
   }
 
   oops::Log::trace() << classname() << "::Fields done" << std::endl;
@@ -144,44 +153,49 @@ Fields::Fields(const Fields & other,
 
 Fields::Fields(const Fields & other,
                const bool copy)
-  : geom_(other.geom_), vars_(other.vars_), time_(other.time_) {
+  : geom_(other.geom_), vars_(other.vars_), time_(other.time_),
+    descriptorsValid_(false), storageToken_(std::make_shared<int>(0)), pendingZero_(false),
+    exported_(false), view_(false) {
   oops::Log::trace() << classname() << "::Fields starting" << std::endl;
 
   // Reset ATLAS fieldset
   fset_ = atlas::FieldSet();
 
-  for (const auto & var : vars_) {
-    // Create field
-    atlas::Field field = geom_->functionSpace().createField<double>(
-      atlas::option::name(var.name()) | atlas::option::levels(var.getLevels()));
-    fset_.add(field);
-  }
-
-  // Set interpolation type
-  for (auto field : fset_) {
-    field.metadata() = other.fset_[field.name()].metadata();
-    if (!field.metadata().has("interp_type")) {
-      field.metadata().set("interp_type", "default");
+  if (copy && !other.view_ && !other.exported_) {
+    // Share fields with the source until one of them is modified
+    for (const auto & var : vars_) {
+      fset_.add(other.fset_[var.name()]);
+    }
+    storageToken_ = other.storageToken_;
+    pendingZero_ = other.pendingZero_;
+  } else {
+    for (const auto & var : vars_) {
+      // Create field
+      atlas::Field field = createField(var.name(), var.getLevels());
+      fset_.add(field);
     }
-  }
 
-  // Set fields to zero
-  this->zero();
+    // Set interpolation type
+    for (auto field : fset_) {
+      field.metadata() = other.fset_[field.name()].metadata();
+      if (!field.metadata().has("interp_type")) {
+        field.metadata().set("interp_type", "default");
+      }
+    }
 
-  // Copy if necessary
-  if (copy) {
-    for (const auto & var : vars_) {
-      atlas::Field field = fset_[var.name()];
-      const atlas::Field fieldOther = other.fset_[var.name()];
-      if (field.rank() == 2) {
-        auto view = atlas::array::make_view<double, 2>(field);
-        const auto viewOther = atlas::array::make_view<double, 2>(fieldOther);
-        for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-          for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-            view(jnode, jlevel) = viewOther(jnode, jlevel);
-          }
+    if (copy) {
+      // Copy fields of a view
+      for (const auto & var : vars_) {
+        atlas::Field field = fset_[var.name()];
+        const atlas::Field fieldOther = other.fset_[var.name()];
+        if (field.rank() == 2) {
+          copyFieldData(fieldOther, field);
         }
       }
+    } else {
+      // Set fields to zero (lazily)
+      pendingZero_ = true;
+      fset_.set_dirty(false);
     }
   }
 
@@ -191,36 +205,78 @@ Fields::Fields(const Fields & other,
 // -----------------------------------------------------------------------------
 
 Fields::Fields(const Fields & other)
-  : geom_(other.geom_), vars_(other.vars_), time_(other.time_) {
+  : geom_(other.geom_), vars_(other.vars_), time_(other.time_),
+    descriptorsValid_(false), storageToken_(std::make_shared<int>(0)), pendingZero_(false),
+    exported_(false), view_(false) {
   oops::Log::trace() << classname() << "::Fields starting" << std::endl;
 
   // Reset ATLAS fieldset
   fset_ = atlas::FieldSet();
 
-  // Create fields and copy data
-  for (const auto & var : vars_) {
-    // Create field
-    atlas::Field field = geom_->functionSpace().createField<double>(
-      atlas::option::name(var.name()) | atlas::option::levels(var.getLevels()));
-    const atlas::Field fieldOther = other.fset_[var.name()];
-    if (field.rank() == 2) {
-      auto view = atlas::array::make_view<double, 2>(field);
-      const auto viewOther = atlas::array::make_view<double, 2>(fieldOther);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          view(jnode, jlevel) = viewOther(jnode, jlevel);
-        }
+  if (other.view_ || other.exported_) {
+    // Create fields and copy data of a view or of fields exported to a caller
+    other.materializeZero();
+    for (const auto & var : vars_) {
+      // Create field
+      atlas::Field field = createField(var.name(), var.getLevels());
+      const atlas::Field fieldOther = other.fset_[var.name()];
+      field.metadata() = fieldOther.metadata();
+      if (field.rank() == 2) {
+        copyFieldData(fieldOther, field);
       }
+      fset_.add(field);
     }
-    fset_.add(field);
-  }
 
-  // Set interpolation type
-  for (auto field : fset_) {
-    field.metadata() = other.fset_[field.name()].metadata();
-    if (!field.metadata().has("interp_type")) {
-      field.metadata().set("interp_type", "default");
+    // Set interpolation type
+    for (auto field : fset_) {
+      if (!field.metadata().has("interp_type")) {
+        field.metadata().set("interp_type", "default");
+      }
     }
+  } else {
+    // Share fields with the source until one of them is modified
+    for (const auto & var : vars_) {
+      fset_.add(other.fset_[var.name()]);
+    }
+    storageToken_ = other.storageToken_;
+    pendingZero_ = other.pendingZero_;
+  }
+
+  oops::Log::trace() << classname() << "::Fields done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+Fields::Fields(Fields && other)
+  : geom_(std::move(other.geom_)), vars_(std::move(other.vars_)), time_(other.time_),
+    fset_(std::move(other.fset_)), descriptors_(std::move(other.descriptors_)),
+    descriptorsValid_(other.descriptorsValid_), storageToken_(std::move(other.storageToken_)),
+    pendingZero_(other.pendingZero_), exported_(other.exported_), view_(other.view_),
+    viewStorage_(std::move(other.viewStorage_)) {
+  oops::Log::trace() << classname() << "::Fields starting" << std::endl;
+
+  // Invalidate moved-from descriptors
+  other.descriptorsValid_ = false;
+  other.view_ = false;
+
+  oops::Log::trace() << classname() << "::Fields done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+Fields::Fields(EnsembleFields & ens,
+               const size_t & member)
+  : geom_(ens.geometry()), vars_(ens.variables()), time_(ens.time()),
+    descriptorsValid_(false), storageToken_(std::make_shared<int>(0)), pendingZero_(false),
+    exported_(false), view_(true) {
+  oops::Log::trace() << classname() << "::Fields starting" << std::endl;
+
+  // Share member storage
+  fset_ = ens.memberFieldSet(member);
+
+  // Keep the ensemble storage alive
+  for (const auto & var : vars_) {
+    viewStorage_.push_back(ens.storage(var.name()));
   }
 
   oops::Log::trace() << classname() << "::Fields done" << std::endl;
@@ -228,15 +284,34 @@ Fields::Fields(const Fields & other)
 
 // -----------------------------------------------------------------------------
 
+Fields::~Fields() {
+  oops::Log::trace() << classname() << "::~Fields starting" << std::endl;
+
+  // Give fields back to the pool
+  releaseFields();
+
+  oops::Log::trace() << classname() << "::~Fields done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
 void Fields::zero() {
   oops::Log::trace() << classname() << "::zero starting" << std::endl;
 
-  for (const auto & var : vars_) {
-    atlas::Field field = fset_[var.name()];
-    if (field.rank() == 2) {
-      auto view = atlas::array::make_view<double, 2>(field);
-      view.assign(0.0);
+  if (view_) {
+    // Zero the ensemble member storage
+    for (const auto & desc : descriptors()) {
+      if (desc.field.rank() == 2) {
+        visitFieldStorage(desc.field, [&](auto tag) {
+          using T = decltype(tag);
+          std::fill(desc.dataAs<T>(), desc.dataAs<T>()+desc.nnodes*desc.nlevs, 0.0);
+        });
+      }
     }
+  } else {
+    // Zero lazily
+    unshare(true);
+    pendingZero_ = true;
   }
   fset_.set_dirty(false);
 
@@ -248,18 +323,23 @@ void Fields::zero() {
 void Fields::constantValue(const double & value) {
   oops::Log::trace() << classname() << "::constantValue starting" << std::endl;
 
-  for (const auto & var : vars_) {
-    atlas::Field field = fset_[var.name()];
-    const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var.name()));
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    if (field.rank() == 2) {
-      auto view = atlas::array::make_view<double, 2>(field);
-      view.assign(0.0);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          if (gmaskView(jnode, jlevel) == 1) view(jnode, jlevel) = value;
+  unshare(true);
+  const std::vector<FieldDescriptor> & descs = descriptors();
+  for (size_t jvar = 0; jvar < descs.size(); ++jvar) {
+    const FieldDescriptor & desc = descs[jvar];
+    const MaskSegments & segments = *desc.gmaskSegments;
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        T * data = desc.dataAs<T>();
+        std::fill(data, data+desc.nnodes*desc.nlevs, 0.0);
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+            data[jj] = value;
+          }
         }
-      }
+      });
     }
   }
   fset_.set_dirty(false);
@@ -272,19 +352,25 @@ void Fields::constantValue(const double & value) {
 void Fields::constantValue(const std::vector<double> & profile) {
   oops::Log::trace() << classname() << "::constantValue starting" << std::endl;
 
-  for (const auto & var : vars_) {
-    atlas::Field field = fset_[var.name()];
-    const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var.name()));
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    if (field.rank() == 2) {
-      ASSERT(field.shape(1) == static_cast<int>(profile.size()));
-      auto view = atlas::array::make_view<double, 2>(field);
-      view.assign(0.0);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          if (gmaskView(jnode, jlevel) == 1) view(jnode, jlevel) = profile[jlevel];
+  unshare(true);
+  const std::vector<FieldDescriptor> & descs = descriptors();
+  for (size_t jvar = 0; jvar < descs.size(); ++jvar) {
+    const FieldDescriptor & desc = descs[jvar];
+    const MaskSegments & segments = *desc.gmaskSegments;
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        ASSERT(desc.nlevs == profile.size());
+        T * data = desc.dataAs<T>();
+        std::fill(data, data+desc.nnodes*desc.nlevs, 0.0);
+        const size_t nlevs = desc.nlevs;
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+            data[jj] = profile[jj%nlevs];
+          }
         }
-      }
+      });
     }
   }
   fset_.set_dirty(false);
@@ -296,22 +382,25 @@ void Fields::constantValue(const std::vector<double> & profile) {
 
 void Fields::constantValue(const eckit::Configuration & config) {
   oops::Log::trace() << "Fields::constantValue starting" << std::endl;
+  unshare();
   for (const auto & group : config.getSubConfigurations("constant group-specific value")) {
     const std::vector<std::string> vars = group.getStringVector("variables");
     const double value = group.getDouble("constant value");
-    for (const auto & var : vars_) {
-      if (std::find(vars.begin(), vars.end(), var.name()) != vars.end()) {
-        atlas::Field field = fset_[var.name()];
-        const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var.name()));
-        const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-        if (field.rank() == 2) {
-          auto view = atlas::array::make_view<double, 2>(field);
-          view.assign(0.0);
-          for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-            for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-              if (gmaskView(jnode, jlevel) == 1) view(jnode, jlevel) = value;
+    for (const auto & desc : descriptors()) {
+      if (std::find(vars.begin(), vars.end(), desc.name) != vars.end()) {
+        const MaskSegments & segments = *desc.gmaskSegments;
+        if (desc.field.rank() == 2) {
+          visitFieldStorage(desc.field, [&](auto tag) {
+            using T = decltype(tag);
+            T * data = desc.dataAs<T>();
+            std::fill(data, data+desc.nnodes*desc.nlevs, 0.0);
+            #pragma omp parallel for schedule(static)
+            for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+              for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+                data[jj] = value;
+              }
             }
-          }
+          });
         }
       }
     }
@@ -326,18 +415,38 @@ void Fields::constantValue(const eckit::Configuration & config) {
 Fields & Fields::operator=(const Fields & rhs) {
   oops::Log::trace() << classname() << "::operator= starting" << std::endl;
 
-  for (const auto & var : vars_.variables()) {
-    atlas::Field field = fset_[var];
-    const atlas::Field fieldRhs = rhs.fset_[var];
-    if (field.rank() == 2) {
-      auto view = atlas::array::make_view<double, 2>(field);
-      const auto viewRhs = atlas::array::make_view<double, 2>(fieldRhs);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          view(jnode, jlevel) = viewRhs(jnode, jlevel);
-        }
+  if (this == &rhs) {
+    // Self-assignment
+  } else if (!view_ && !rhs.view_ && !rhs.exported_ && geom_ == rhs.geom_
+    && (storageToken_.use_count() > 1 || pendingZero_)) {
+    // No exclusive values to keep: share fields with the right-hand side until one of them is
+    // modified (exclusive buffers are reused by the copy below, avoiding a release and a new
+    // allocation on the next modification)
+    atlas::FieldSet fset;
+    for (const auto & var : vars_) {
+      fset.add(rhs.fset_[var.name()]);
+    }
+    releaseFields();
+    fset_ = fset;
+    storageToken_ = rhs.storageToken_;
+    pendingZero_ = rhs.pendingZero_;
+    exported_ = false;
+  } else {
+    // Copy values
+    unshare(true);
+    const std::vector<FieldDescriptor> & descs = descriptors();
+    for (size_t jvar = 0; jvar < descs.size(); ++jvar) {
+      const FieldDescriptor & desc = descs[jvar];
+      const FieldDescriptor & descRhs = rhs.descriptor(jvar, desc.name);
+      if (desc.field.rank() == 2) {
+        visitFieldStorage(desc.field, [&](auto tag) {
+          using T = decltype(tag);
+          const T * dataRhs = descRhs.dataAs<T>();
+          std::copy(dataRhs, dataRhs+desc.nnodes*desc.nlevs, desc.dataAs<T>());
+        });
+        desc.field.metadata() = descRhs.field.metadata();
+        desc.field.set_dirty(descRhs.field.dirty());
       }
-      field.set_dirty(fieldRhs.dirty());
     }
   }
   time_ = rhs.time_;
@@ -348,38 +457,66 @@ Fields & Fields::operator=(const Fields & rhs) {
 
 // -----------------------------------------------------------------------------
 
+Fields & Fields::operator=(Fields && rhs) {
+  oops::Log::trace() << classname() << "::operator= starting" << std::endl;
+
+  if (view_) {
+    // Copy values into the ensemble member storage
+    *this = static_cast<const Fields &>(rhs);
+  } else if (this != &rhs) {
+    releaseFields();
+    geom_ = std::move(rhs.geom_);
+    vars_ = std::move(rhs.vars_);
+    time_ = rhs.time_;
+    fset_ = std::move(rhs.fset_);
+    descriptors_ = std::move(rhs.descriptors_);
+    descriptorsValid_ = rhs.descriptorsValid_;
+    rhs.descriptorsValid_ = false;
+    storageToken_ = std::move(rhs.storageToken_);
+    pendingZero_ = rhs.pendingZero_;
+    exported_ = rhs.exported_;
+    view_ = rhs.view_;
+    viewStorage_ = std::move(rhs.viewStorage_);
+    rhs.view_ = false;
+  }
+
+  oops::Log::trace() << classname() << "::operator= end" << std::endl;
+  return *this;
+}
+
+// -----------------------------------------------------------------------------
+
 Fields & Fields::operator+=(const Fields & rhs) {
   oops::Log::trace() << classname() << "::operator+= starting" << std::endl;
 
-  // Right-hand side fieldset
-  atlas::FieldSet fsetRhs;
-  if (geom_->grid() == rhs.geom_->grid() && geom_->halo() == rhs.geom_->halo()) {
-    // Same geometry
-    fsetRhs = util::shareFields(rhs.fset_);
-  } else {
-    // Interpolate
-    const Fields rhsInterp(rhs, *geom_);
+  unshare();
 
-    // Copy fieldset
-    fsetRhs = util::copyFieldSet(rhsInterp.fset_);
+  // Right-hand side fields
+  const Fields * rhsPtr = &rhs;
+  std::unique_ptr<Fields> rhsInterp;
+  if (geom_->grid() != rhs.geom_->grid() || geom_->halo() != rhs.geom_->halo()) {
+    // Interpolate
+    rhsInterp.reset(new Fields(rhs, *geom_));
+    rhsPtr = rhsInterp.get();
   }
 
-  for (const auto & var : vars_) {
-    atlas::Field field = fset_[var.name()];
-    const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var.name()));
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    const atlas::Field fieldRhs = fsetRhs[var.name()];
-    if (field.rank() == 2) {
-      auto view = atlas::array::make_view<double, 2>(field);
-      const auto viewRhs = atlas::array::make_view<double, 2>(fieldRhs);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          if (gmaskView(jnode, jlevel) == 1) {
-            view(jnode, jlevel) += viewRhs(jnode, jlevel);
-          }
+  const std::vector<FieldDescriptor> & descs = descriptors();
+  for (size_t jvar = 0; jvar < descs.size(); ++jvar) {
+    const FieldDescriptor & desc = descs[jvar];
+    const MaskSegments & segments = *desc.gmaskSegments;
+    const FieldDescriptor & descRhs = rhsPtr->descriptor(jvar, desc.name);
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        T * data = desc.dataAs<T>();
+        const T * dataRhs = descRhs.dataAs<T>();
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          const size_t j0 = segments[jseg][0];
+          kernelAdd(segments[jseg][1]-j0, dataRhs+j0, data+j0);
         }
-      }
-      field.set_dirty(field.dirty() || fieldRhs.dirty());
+      });
+      desc.field.set_dirty(desc.field.dirty() || descRhs.field.dirty());
     }
   }
 
@@ -392,22 +529,25 @@ Fields & Fields::operator+=(const Fields & rhs) {
 Fields & Fields::operator-=(const Fields & rhs) {
   oops::Log::trace() << classname() << "::operator-= starting" << std::endl;
 
-  for (const auto & var : vars_) {
-    atlas::Field field = fset_[var.name()];
-    const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var.name()));
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    const atlas::Field fieldRhs = rhs.fset_[var.name()];
-    if (field.rank() == 2) {
-      auto view = atlas::array::make_view<double, 2>(field);
-      const auto viewRhs = atlas::array::make_view<double, 2>(fieldRhs);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          if (gmaskView(jnode, jlevel) == 1) {
-            view(jnode, jlevel) -= viewRhs(jnode, jlevel);
-          }
+  unshare();
+
+  const std::vector<FieldDescriptor> & descs = descriptors();
+  for (size_t jvar = 0; jvar < descs.size(); ++jvar) {
+    const FieldDescriptor & desc = descs[jvar];
+    const MaskSegments & segments = *desc.gmaskSegments;
+    const FieldDescriptor & descRhs = rhs.descriptor(jvar, desc.name);
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        T * data = desc.dataAs<T>();
+        const T * dataRhs = descRhs.dataAs<T>();
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          const size_t j0 = segments[jseg][0];
+          kernelSub(segments[jseg][1]-j0, dataRhs+j0, data+j0);
         }
-      }
-      field.set_dirty(field.dirty() || fieldRhs.dirty());
+      });
+      desc.field.set_dirty(desc.field.dirty() || descRhs.field.dirty());
     }
   }
 
@@ -420,19 +560,22 @@ Fields & Fields::operator-=(const Fields & rhs) {
 Fields & Fields::operator*=(const double & zz) {
   oops::Log::trace() << classname() << "::operator*= starting" << std::endl;
 
-  for (const auto & var : vars_) {
-    atlas::Field field = fset_[var.name()];
-    const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var.name()));
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    if (field.rank() == 2) {
-      auto view = atlas::array::make_view<double, 2>(field);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          if (gmaskView(jnode, jlevel) == 1) {
-            view(jnode, jlevel) *= zz;
-          }
+  unshare();
+
+  const std::vector<FieldDescriptor> & descs = descriptors();
+  for (size_t jvar = 0; jvar < descs.size(); ++jvar) {
+    const FieldDescriptor & desc = descs[jvar];
+    const MaskSegments & segments = *desc.gmaskSegments;
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        T * data = desc.dataAs<T>();
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          const size_t j0 = segments[jseg][0];
+          kernelScale(segments[jseg][1]-j0, zz, data+j0);
         }
-      }
+      });
     }
   }
 
@@ -446,22 +589,25 @@ void Fields::axpy(const double & zz,
                   const Fields & rhs) {
   oops::Log::trace() << classname() << "::axpy starting" << std::endl;
 
-  for (const auto & var : vars_) {
-    atlas::Field field = fset_[var.name()];
-    const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var.name()));
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    const atlas::Field fieldRhs = rhs.fset_[var.name()];
-    if (field.rank() == 2) {
-      auto view = atlas::array::make_view<double, 2>(field);
-      const auto viewRhs = atlas::array::make_view<double, 2>(fieldRhs);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          if (gmaskView(jnode, jlevel) == 1) {
-            view(jnode, jlevel) += zz * viewRhs(jnode, jlevel);
-          }
+  unshare();
+
+  const std::vector<FieldDescriptor> & descs = descriptors();
+  for (size_t jvar = 0; jvar < descs.size(); ++jvar) {
+    const FieldDescriptor & desc = descs[jvar];
+    const MaskSegments & segments = *desc.gmaskSegments;
+    const FieldDescriptor & descRhs = rhs.descriptor(jvar, desc.name);
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        T * data = desc.dataAs<T>();
+        const T * dataRhs = descRhs.dataAs<T>();
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          const size_t j0 = segments[jseg][0];
+          kernelAxpy(segments[jseg][1]-j0, zz, dataRhs+j0, data+j0);
         }
-      }
-      field.set_dirty(field.dirty() || fieldRhs.dirty());
+      });
+      desc.field.set_dirty(desc.field.dirty() || descRhs.field.dirty());
     }
   }
 
@@ -470,54 +616,260 @@ void Fields::axpy(const double & zz,
 
 // -----------------------------------------------------------------------------
 
-double Fields::dot_product_with(const Fields & fld2) const {
-  oops::Log::trace() << classname() << "::dot_product_with starting" << std::endl;
+void Fields::axpby(const double & zz1,
+                   const double & zz2,
+                   const Fields & rhs) {
+  oops::Log::trace() << classname() << "::axpby starting" << std::endl;
+
+  unshare();
+
+  const std::vector<FieldDescriptor> & descs = descriptors();
+  for (size_t jvar = 0; jvar < descs.size(); ++jvar) {
+    const FieldDescriptor & desc = descs[jvar];
+    const MaskSegments & segments = *desc.gmaskSegments;
+    const FieldDescriptor & descRhs = rhs.descriptor(jvar, desc.name);
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        T * data = desc.dataAs<T>();
+        const T * dataRhs = descRhs.dataAs<T>();
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          const size_t j0 = segments[jseg][0];
+          kernelScale(segments[jseg][1]-j0, zz1, data+j0);
+          kernelAxpy(segments[jseg][1]-j0, zz2, dataRhs+j0, data+j0);
+        }
+      });
+      desc.field.set_dirty(desc.field.dirty() || descRhs.field.dirty());
+    }
+  }
 
-  double zz = 0;
-  const auto ownedView = atlas::array::make_view<int, 2>(geom_->fields().field("owned"));
-  for (const auto & var : vars_) {
-    const atlas::Field field1 = fset_[var.name()];
-    const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var.name()));
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    const atlas::Field field2 = fld2.fset_[var.name()];
-    if (field1.rank() == 2) {
-      const auto view1 = atlas::array::make_view<double, 2>(field1);
-      const auto view2 = atlas::array::make_view<double, 2>(field2);
-      for (atlas::idx_t jnode = 0; jnode < field1.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field1.shape(1); ++jlevel) {
-          if (gmaskView(jnode, jlevel) == 1 && ownedView(jnode, 0) == 1) {
-            zz += view1(jnode, jlevel)*view2(jnode, jlevel);
+  oops::Log::trace() << classname() << "::axpby done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void Fields::linearCombination(const std::vector<double> & coeffs,
+                               const std::vector<const Fields*> & members) {
+  oops::Log::trace() << classname() << "::linearCombination starting" << std::endl;
+
+  unshare();
+
+  // Check sizes
+  ASSERT(!members.empty());
+  ASSERT(coeffs.size() == members.size());
+
+  // Check aliasing, this Fields is overwritten before later members are read
+  for (const auto & member : members) {
+    ASSERT(member != this);
+  }
+
+  const std::vector<FieldDescriptor> & descs = descriptors();
+  for (size_t jvar = 0; jvar < descs.size(); ++jvar) {
+    const FieldDescriptor & desc = descs[jvar];
+    const MaskSegments & segments = *desc.gmaskSegments;
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        T * data = desc.dataAs<T>();
+
+        // Get members data
+        std::vector<const T *> dataMembers;
+        bool dirty = false;
+        for (const auto & member : members) {
+          const FieldDescriptor & descMember = member->descriptor(jvar, desc.name);
+          dataMembers.push_back(descMember.dataAs<T>());
+          dirty = dirty || descMember.field.dirty();
+        }
+
+        // Combine members segment by segment, the segment staying in cache between members
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+            data[jj] = coeffs[0]*dataMembers[0][jj];
+          }
+          for (size_t jm = 1; jm < members.size(); ++jm) {
+            const T * dataMember = dataMembers[jm];
+            for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+              data[jj] += coeffs[jm]*dataMember[jj];
+            }
           }
         }
-      }
+        desc.field.set_dirty(dirty);
+      });
+    }
+  }
+
+  oops::Log::trace() << classname() << "::linearCombination done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void Fields::ensembleMeanAndPerturbations(const std::vector<Fields*> & members) {
+  oops::Log::trace() << classname() << "::ensembleMeanAndPerturbations starting" << std::endl;
+
+  unshare();
+  for (const auto & member : members) {
+    member->unshare();
+  }
+
+  // Check size
+  ASSERT(!members.empty());
+  const double rnm = 1.0/static_cast<double>(members.size());
+
+  const std::vector<FieldDescriptor> & descs = descriptors();
+  for (size_t jvar = 0; jvar < descs.size(); ++jvar) {
+    const FieldDescriptor & desc = descs[jvar];
+    const MaskSegments & segments = *desc.gmaskSegments;
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        T * data = desc.dataAs<T>();
+
+        // Get members data
+        std::vector<T *> dataMembers;
+        bool dirty = false;
+        for (const auto & member : members) {
+          const FieldDescriptor & descMember = member->descriptor(jvar, desc.name);
+          dataMembers.push_back(descMember.dataAs<T>());
+          dirty = dirty || descMember.field.dirty();
+        }
+
+        // Compute mean and remove it from members, segment by segment (accumulated in double)
+        // One mean buffer per thread, sized for the longest segment
+        size_t maxLength = 0;
+        for (const auto & segment : segments) {
+          maxLength = std::max(maxLength, segment[1]-segment[0]);
+        }
+        #pragma omp parallel
+        {
+          std::vector<double> mean(maxLength);
+          #pragma omp for schedule(static)
+          for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+            const size_t offset = segments[jseg][0];
+            std::fill(mean.begin(), mean.begin()+(segments[jseg][1]-offset), 0.0);
+            for (size_t jm = 0; jm < members.size(); ++jm) {
+              const T * dataMember = dataMembers[jm];
+              for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+                mean[jj-offset] += dataMember[jj];
+              }
+            }
+            for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+              mean[jj-offset] *= rnm;
+              data[jj] = mean[jj-offset];
+            }
+            for (size_t jm = 0; jm < members.size(); ++jm) {
+              T * dataMember = dataMembers[jm];
+              for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+                dataMember[jj] -= mean[jj-offset];
+              }
+            }
+          }
+        }
+        desc.field.set_dirty(dirty);
+        for (const auto & member : members) {
+          member->descriptor(jvar, desc.name).field.set_dirty(dirty);
+        }
+      });
     }
   }
+
+  oops::Log::trace() << classname() << "::ensembleMeanAndPerturbations done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+double Fields::dot_product_with(const Fields & fld2) const {
+  oops::Log::trace() << classname() << "::dot_product_with starting" << std::endl;
+
+  double zz = localDotProductWith(fld2);
   geom_->getComm().allReduceInPlace(zz, eckit::mpi::sum());
+
   oops::Log::trace() << classname() << "::dot_product_with done" << std::endl;
   return zz;
 }
 
 // -----------------------------------------------------------------------------
 
+std::vector<double> Fields::dot_products_with(const std::vector<const Fields*> & others) const {
+  oops::Log::trace() << classname() << "::dot_products_with starting" << std::endl;
+
+  // Nothing to reduce
+  if (others.empty()) {
+    oops::Log::trace() << classname() << "::dot_products_with done" << std::endl;
+    return std::vector<double>();
+  }
+
+  // Local dot products
+  std::vector<double> zz;
+  for (const auto & other : others) {
+    zz.push_back(localDotProductWith(*other));
+  }
+
+  // Single reduction
+  geom_->getComm().allReduceInPlace(zz.begin(), zz.end(), eckit::mpi::sum());
+
+  oops::Log::trace() << classname() << "::dot_products_with done" << std::endl;
+  return zz;
+}
+
+// -----------------------------------------------------------------------------
+
+double Fields::localDotProductWith(const Fields & fld2) const {
+  oops::Log::trace() << classname() << "::localDotProductWith starting" << std::endl;
+
+  double zz = 0;
+  const std::vector<FieldDescriptor> & descs = descriptors();
+  for (size_t jvar = 0; jvar < descs.size(); ++jvar) {
+    const FieldDescriptor & desc1 = descs[jvar];
+    const MaskSegments & segments = *desc1.gmaskOwnedSegments;
+    const FieldDescriptor & desc2 = fld2.descriptor(jvar, desc1.name);
+    if (desc1.field.rank() == 2) {
+      visitFieldStorage(desc1.field, [&](auto tag) {
+        using T = decltype(tag);
+        const T * data1 = desc1.dataAs<T>();
+        const T * data2 = desc2.dataAs<T>();
+        std::vector<double> zzSeg(segments.size(), 0.0);
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          const size_t j0 = segments[jseg][0];
+          zzSeg[jseg] = kernelDot(segments[jseg][1]-j0, data1+j0, data2+j0);
+        }
+        for (const auto & item : zzSeg) {
+          zz += item;
+        }
+      });
+    }
+  }
+
+  oops::Log::trace() << classname() << "::localDotProductWith done" << std::endl;
+  return zz;
+}
+
+// -----------------------------------------------------------------------------
+
 void Fields::schur_product_with(const Fields & fld2) {
   oops::Log::trace() << classname() << "::schur_product_with starting" << std::endl;
 
-  for (const auto & var : vars_) {
-    atlas::Field field = fset_[var.name()];
-    const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var.name()));
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    const atlas::Field field2 = fld2.fset_[var.name()];
-    if (field.rank() == 2) {
-      auto view = atlas::array::make_view<double, 2>(field);
-      const auto view2 = atlas::array::make_view<double, 2>(field2);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          if (gmaskView(jnode, jlevel) == 1) {
-            view(jnode, jlevel) *= view2(jnode, jlevel);
-          }
+  unshare();
+
+  const std::vector<FieldDescriptor> & descs = descriptors();
+  for (size_t jvar = 0; jvar < descs.size(); ++jvar) {
+    const FieldDescriptor & desc = descs[jvar];
+    const MaskSegments & segments = *desc.gmaskSegments;
+    const FieldDescriptor & desc2 = fld2.descriptor(jvar, desc.name);
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        T * data = desc.dataAs<T>();
+        const T * data2 = desc2.dataAs<T>();
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          const size_t j0 = segments[jseg][0];
+          kernelSchur(segments[jseg][1]-j0, data2+j0, data+j0);
         }
-      }
-      field.set_dirty(field.dirty() || field2.dirty());
+      });
+      desc.field.set_dirty(desc.field.dirty() || desc2.field.dirty());
     }
   }
 
@@ -529,29 +881,52 @@ void Fields::schur_product_with(const Fields & fld2) {
 void Fields::random() {
   oops::Log::trace() << classname() << "::random starting" << std::endl;
 
-  fset_.clear();
+  if (view_) {
+    // Generate exclusive fields, then copy them into the ensemble member storage
+    Fields fields(*geom_, vars_, time_);
+    fields.random();
+    *this = fields;
+    oops::Log::trace() << "Fields::random done" << std::endl;
+    return;
+  }
+
+  releaseFields();
+  resetStorage();
+
+  if (geom_->counterBasedRandom()) {
+    // Local counter-based generator
+    randomCounterBased();
+  } else {
+    // Normal distribution drawn on the main task
+    randomNormalDistribution();
+  }
+
+  // Set duplicate points to the same value
+  resetDuplicatePoints();
+
+  oops::Log::trace() << "Fields::random done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void Fields::randomNormalDistribution() {
+  oops::Log::trace() << classname() << "::randomNormalDistribution starting" << std::endl;
+
   for (size_t groupIndex = 0; groupIndex < geom_->groups(); ++groupIndex) {
-    // Mask and ghost points fields
+    // Mask name
     const std::string gmaskName = "gmask_" + std::to_string(groupIndex);
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    const auto ghostView = atlas::array::make_view<int, 1>(geom_->functionSpace().ghost());
+
+    // Number of active non-ghost points in the group
+    size_t nGroup = 0;
+    for (const auto & segment : geom_->gmaskNoGhostSegments(groupIndex)) {
+      nGroup += segment[1]-segment[0];
+    }
 
     // Total size
     size_t n = 0;
-    std::vector<std::string> groupVars;
     for (const auto & var : vars_) {
       if (geom_->groupIndex(var.name()) == groupIndex) {
-        groupVars.push_back(var.name());
-      }
-    }
-    for (const auto & var : groupVars) {
-      const atlas::Field field = fset_[var];
-      if (field.rank() == 2) {
-        for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-          for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-            if (gmaskView(jnode, jlevel) == 1 && ghostView(jnode) == 0) ++n;
-          }
-        }
+        n += nGroup;
       }
     }
     geom_->getComm().allReduceInPlace(n, eckit::mpi::sum());
@@ -664,17 +1039,67 @@ void Fields::random() {
     // Copy data
     for (const auto & var : vars_) {
       if (geom_->groupIndex(var.name()) == groupIndex) {
-        fset_.add(localData[var.name()]);
+        atlas::Field field = localData[var.name()];
+        field.metadata().set("interp_type", "default");
+        fset_.add(field);
       }
     }
   }
 
   fset_.set_dirty();  // code is too complicated, mark dirty to be safe
 
-  // Set duplicate points to the same value
-  resetDuplicatePoints();
+  // Convert storage precision if needed
+  convertFieldsPrecision();
 
-  oops::Log::trace() << "Fields::random done" << std::endl;
+  oops::Log::trace() << classname() << "::randomNormalDistribution done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void Fields::randomCounterBased() {
+  oops::Log::trace() << classname() << "::randomCounterBased starting" << std::endl;
+
+  // Seed
+  const uint64_t seed = 1;
+
+  // Global index and ghost points
+  const auto gidxView = atlas::array::make_view<atlas::gidx_t, 1>(
+    geom_->functionSpace().global_index());
+  const auto ghostView = atlas::array::make_view<int, 1>(geom_->functionSpace().ghost());
+
+  for (const auto & var : vars_) {
+    // Create field
+    atlas::Field field = createField(var.name(), var.getLevels());
+
+    // Mask
+    const size_t groupIndex = geom_->groupIndex(var.name());
+    const std::string gmaskName = "gmask_" + std::to_string(groupIndex);
+    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
+
+    // Fill active non-ghost points, random values are keyed on the global index, the level and
+    // the variable, so that they do not depend on the MPI/OpenMP decomposition
+    const uint32_t key = stringKey(var.name());
+    visitFieldStorage(field, [&](auto tag) {
+      using T = decltype(tag);
+      auto view = atlas::array::make_view<T, 2>(field);
+      #pragma omp parallel for schedule(static)
+      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
+        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
+          if (gmaskView(jnode, jlevel) == 1 && ghostView(jnode) == 0) {
+            view(jnode, jlevel) = static_cast<T>(counterBasedNormal(seed,
+              static_cast<uint64_t>(gidxView(jnode)), static_cast<uint32_t>(jlevel), key));
+          } else {
+            view(jnode, jlevel) = 0.0;
+          }
+        }
+      }
+    });
+    field.metadata().set("interp_type", "default");
+    field.set_dirty();
+    fset_.add(field);
+  }
+
+  oops::Log::trace() << classname() << "::randomCounterBased done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
@@ -687,6 +1112,8 @@ void Fields::dirac(const eckit::Configuration & config) {
     const eckit::LocalConfiguration file(config, "file");
     this->read(file);
   } else {
+    unshare();
+
     // Get dirac specifications
     std::vector<double> lon = config.getDoubleVector("lon");
     std::vector<double> lat = config.getDoubleVector("lat");
@@ -723,8 +1150,9 @@ void Fields::dirac(const eckit::Configuration & config) {
     }
     search.build();
 
-    // Set fields to zero
+    // Set fields to zero (the lazy zero is applied now, since dirac points are written directly)
     this->zero();
+    materializeZero();
 
     // Set dirac points
     for (size_t jdir = 0; jdir < lon.size(); ++jdir) {
@@ -774,8 +1202,11 @@ void Fields::dirac(const eckit::Configuration & config) {
 
         // Add Dirac impulse
         if (field.rank() == 2) {
-          auto view = atlas::array::make_view<double, 2>(field);
-          view(index, level[jdir]-1) = 1.0;
+          visitFieldStorage(field, [&](auto tag) {
+            using T = decltype(tag);
+            auto view = atlas::array::make_view<T, 2>(field);
+            view(index, level[jdir]-1) = 1.0;
+          });
         }
       }
 
@@ -805,24 +1236,28 @@ void Fields::diff(const Fields & x1,
                   const Fields & x2) {
   oops::Log::trace() << classname() << "::diff starting" << std::endl;
 
-  for (const auto & var : vars_) {
-    atlas::Field field = fset_[var.name()];
-    const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var.name()));
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    atlas::Field fieldx1 = x1.fset_[var.name()];
-    atlas::Field fieldx2 = x2.fset_[var.name()];
-    if (field.rank() == 2) {
-      auto view = atlas::array::make_view<double, 2>(field);
-      auto viewx1 = atlas::array::make_view<double, 2>(fieldx1);
-      auto viewx2 = atlas::array::make_view<double, 2>(fieldx2);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          if (gmaskView(jnode, jlevel) == 1) {
-            view(jnode, jlevel) = viewx1(jnode, jlevel)-viewx2(jnode, jlevel);
+  unshare();
+
+  const std::vector<FieldDescriptor> & descs = descriptors();
+  for (size_t jvar = 0; jvar < descs.size(); ++jvar) {
+    const FieldDescriptor & desc = descs[jvar];
+    const MaskSegments & segments = *desc.gmaskSegments;
+    const FieldDescriptor & descx1 = x1.descriptor(jvar, desc.name);
+    const FieldDescriptor & descx2 = x2.descriptor(jvar, desc.name);
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        T * data = desc.dataAs<T>();
+        const T * datax1 = descx1.dataAs<T>();
+        const T * datax2 = descx2.dataAs<T>();
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+            data[jj] = datax1[jj]-datax2[jj];
           }
         }
-      }
-      field.set_dirty(fieldx1.dirty() || fieldx2.dirty());
+      });
+      desc.field.set_dirty(descx1.field.dirty() || descx2.field.dirty());
     }
   }
 
@@ -835,20 +1270,22 @@ double Fields::min(const varns::Variables & vars) const {
   oops::Log::trace() << classname() << "::min starting" << std::endl;
 
   double zmin = std::numeric_limits<double>::max();
-  const auto ghostView = atlas::array::make_view<int, 1>(geom_->functionSpace().ghost());
   for (const auto & var : vars.variables()) {
-    const atlas::Field field = fset_[var];
-    const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var));
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    if (field.rank() == 2) {
-      const auto view = atlas::array::make_view<double, 2>(field);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          if (gmaskView(jnode, jlevel) == 1 && ghostView(jnode) == 0) {
-            zmin = std::min(zmin, view(jnode, jlevel));
-          }
+    const FieldDescriptor & desc = descriptor(var);
+    const MaskSegments & segments = *desc.gmaskNoGhostSegments;
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        const T * data = desc.dataAs<T>();
+        double zminVar = zmin;
+        #pragma omp parallel for schedule(static) reduction(min:zminVar)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          const size_t j0 = segments[jseg][0];
+          double zmaxSeg = -std::numeric_limits<double>::max();
+          kernelMinMax(segments[jseg][1]-j0, data+j0, zminVar, zmaxSeg);
         }
-      }
+        zmin = zminVar;
+      });
     }
   }
   geom_->getComm().allReduceInPlace(zmin, eckit::mpi::min());
@@ -863,20 +1300,22 @@ double Fields::max(const varns::Variables & vars) const {
   oops::Log::trace() << classname() << "::max starting" << std::endl;
 
   double zmax = -std::numeric_limits<double>::max();
-  const auto ghostView = atlas::array::make_view<int, 1>(geom_->functionSpace().ghost());
   for (const auto & var : vars.variables()) {
-    const atlas::Field field = fset_[var];
-    const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var));
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    if (field.rank() == 2) {
-      const auto view = atlas::array::make_view<double, 2>(field);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          if (gmaskView(jnode, jlevel) == 1 && ghostView(jnode) == 0) {
-            zmax = std::max(zmax, view(jnode, jlevel));
-          }
+    const FieldDescriptor & desc = descriptor(var);
+    const MaskSegments & segments = *desc.gmaskNoGhostSegments;
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        const T * data = desc.dataAs<T>();
+        double zmaxVar = zmax;
+        #pragma omp parallel for schedule(static) reduction(max:zmaxVar)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          const size_t j0 = segments[jseg][0];
+          double zminSeg = std::numeric_limits<double>::max();
+          kernelMinMax(segments[jseg][1]-j0, data+j0, zminSeg, zmaxVar);
         }
-      }
+        zmax = zmaxVar;
+      });
     }
   }
   geom_->getComm().allReduceInPlace(zmax, eckit::mpi::max());
@@ -887,6 +1326,90 @@ double Fields::max(const varns::Variables & vars) const {
 
 // -----------------------------------------------------------------------------
 
+std::vector<FieldStatistics> Fields::statistics(const varns::Variables & vars) const {
+  oops::Log::trace() << classname() << "::statistics starting" << std::endl;
+
+  // Local statistics, packed as [sum, sum of squares, count] and [-min, max] for each variable
+  const size_t nvars = vars.size();
+  std::vector<double> sums(3*nvars, 0.0);
+  std::vector<double> extrema(2*nvars, -std::numeric_limits<double>::max());
+  for (size_t jvar = 0; jvar < nvars; ++jvar) {
+    const FieldDescriptor & desc = descriptor(jvar, vars[jvar].name());
+    const MaskSegments & segments = *desc.gmaskNoGhostSegments;
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        const T * data = desc.dataAs<T>();
+
+        // Single pass, with sums accumulated per segment for reproducibility
+        std::vector<double> sumSeg(segments.size(), 0.0);
+        std::vector<double> sumSquaresSeg(segments.size(), 0.0);
+        double zmin = std::numeric_limits<double>::max();
+        double zmax = -std::numeric_limits<double>::max();
+        #pragma omp parallel for schedule(static) reduction(min:zmin) reduction(max:zmax)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+            const double value = data[jj];
+            sumSeg[jseg] += value;
+            sumSquaresSeg[jseg] += value*value;
+            zmin = std::min(zmin, value);
+            zmax = std::max(zmax, value);
+          }
+        }
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          sums[3*jvar] += sumSeg[jseg];
+          sums[3*jvar+1] += sumSquaresSeg[jseg];
+          sums[3*jvar+2] += static_cast<double>(segments[jseg][1]-segments[jseg][0]);
+        }
+        extrema[2*jvar] = -zmin;
+        extrema[2*jvar+1] = zmax;
+      });
+    }
+  }
+
+  // Single collective for all variables: gather the packed local statistics of all tasks
+  const size_t ntasks = geom_->getComm().size();
+  std::vector<double> local(sums);
+  local.insert(local.end(), extrema.begin(), extrema.end());
+  std::vector<double> global(ntasks*local.size());
+  std::vector<int> counts(ntasks, static_cast<int>(local.size()));
+  std::vector<int> displs(ntasks);
+  for (size_t jt = 0; jt < ntasks; ++jt) {
+    displs[jt] = static_cast<int>(jt*local.size());
+  }
+  geom_->getComm().allGatherv(local.begin(), local.end(), global.begin(), counts.data(),
+    displs.data());
+
+  // Reduce in task order, identical on all tasks
+  std::fill(sums.begin(), sums.end(), 0.0);
+  std::fill(extrema.begin(), extrema.end(), -std::numeric_limits<double>::max());
+  for (size_t jt = 0; jt < ntasks; ++jt) {
+    const double * sumsTask = global.data()+displs[jt];
+    const double * extremaTask = sumsTask+3*nvars;
+    for (size_t jj = 0; jj < 3*nvars; ++jj) {
+      sums[jj] += sumsTask[jj];
+    }
+    for (size_t jj = 0; jj < 2*nvars; ++jj) {
+      extrema[jj] = std::max(extrema[jj], extremaTask[jj]);
+    }
+  }
+
+  // Unpack statistics
+  std::vector<FieldStatistics> stats(nvars);
+  for (size_t jvar = 0; jvar < nvars; ++jvar) {
+    stats[jvar].min = -extrema[2*jvar];
+    stats[jvar].max = extrema[2*jvar+1];
+    stats[jvar].sum = sums[3*jvar];
+    stats[jvar].sumSquares = sums[3*jvar+1];
+    stats[jvar].count = static_cast<size_t>(sums[3*jvar+2]);
+  }
+
+  oops::Log::trace() << classname() << "::statistics done" << std::endl;
+  return stats;
+}
+
+// -----------------------------------------------------------------------------
+
 void Fields::interpolate(const Locations & locs,
                          GeoVaLs & gv) const {
   oops::Log::trace() << classname() << "::interpolate starting" << std::endl;
@@ -895,19 +1418,26 @@ void Fields::interpolate(const Locations & locs,
     // Setup interpolation
     const auto & interpolation = setupObsInterpolation(locs);
 
+    // Interpolated variables only
+    std::vector<std::string> vars;
+    for (const auto & var : gv.fieldSet().field_names()) {
+      if (fset_.has(var)) {
+        vars.push_back(var);
+      }
+    }
+
     // Create observation fieldset
     atlas::FieldSet obsFieldSet;
-    for (const auto & var : vars_.variables()) {
+    for (const auto & var : vars) {
       atlas::Field obsField = interpolation->tgtFspace().createField<double>(
         atlas::option::name(var) | atlas::option::levels(geom_->levels(var)));
       obsFieldSet.add(obsField);
     }
 
-    // Copy FieldSet
-    atlas::FieldSet fset = util::copyFieldSet(fset_);
-
-    // Horizontal interpolation
+    // Horizontal interpolation (halo exchange in place on the model fields)
+    atlas::FieldSet fset = interpolationSource(vars);
     interpolation->execute(fset, obsFieldSet);
+    releaseInterpolationSource(fset);
 
     // Vertical interpolation
     interpolation->executeVertical(obsFieldSet, gv.fieldSet());
@@ -922,6 +1452,8 @@ void Fields::interpolateAD(const Locations & locs,
                            const GeoVaLs & gv) {
   oops::Log::trace() << classname() << "::interpolateAD starting" << std::endl;
 
+  unshare();
+
   if (locs.grid().size() > 0) {
     // Setup interpolation
     const auto & interpolation = setupObsInterpolation(locs);
@@ -938,7 +1470,16 @@ void Fields::interpolateAD(const Locations & locs,
     interpolation->executeVerticalAdjoint(obsFieldSet, gv.fieldSet());
 
     // Horizontal interpolation
-    interpolation->executeAdjoint(fset_, obsFieldSet);
+    if (geom_->singlePrecision()) {
+      // Accumulate in double precision, then copy back
+      atlas::FieldSet fset = copyFieldSetToDouble(fset_);
+      interpolation->executeAdjoint(fset, obsFieldSet);
+      for (auto field : fset_) {
+        copyFieldData(fset[field.name()], field);
+      }
+    } else {
+      interpolation->executeAdjoint(fset_, obsFieldSet);
+    }
 
     // Reduce duplicate points
     reduceDuplicatePoints();
@@ -953,25 +1494,28 @@ void Fields::forceWith(const Fields & other,
                        const varns::Variables & vars) {
   oops::Log::trace() << classname() << "::Fields forceWith" << std::endl;
 
+  unshare();
+
   // Copy time
   time_ = other.time_;
 
   // Copy fields
-  for (const auto & var : vars.variables()) {
-    atlas::Field field = fset_[var];
-    const atlas::Field fieldOther = other.fset_[var];
-    const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var));
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    if (field.rank() == 2) {
-      auto view = atlas::array::make_view<double, 2>(field);
-      const auto viewOther = atlas::array::make_view<double, 2>(fieldOther);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          if (gmaskView(jnode, jlevel) == 1) {
-            view(jnode, jlevel) = viewOther(jnode, jlevel);
+  for (size_t jvar = 0; jvar < vars.size(); ++jvar) {
+    const FieldDescriptor & desc = descriptor(jvar, vars[jvar].name());
+    const FieldDescriptor & descOther = other.descriptor(jvar, vars[jvar].name());
+    const MaskSegments & segments = *desc.gmaskSegments;
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        T * data = desc.dataAs<T>();
+        const T * dataOther = descOther.dataAs<T>();
+        #pragma omp parallel for schedule(static)
+        for (size_t jseg = 0; jseg < segments.size(); ++jseg) {
+          for (size_t jj = segments[jseg][0]; jj < segments[jseg][1]; ++jj) {
+            data[jj] = dataOther[jj];
           }
         }
-      }
+      });
     }
   }
 
@@ -983,9 +1527,17 @@ void Fields::forceWith(const Fields & other,
 void Fields::toFieldSet(atlas::FieldSet & fset) const {
   oops::Log::trace() << classname() << "::toFieldSet starting" << std::endl;
 
-  // Share internal fieldset
+  // Share internal fieldset (or copy it in double precision for single precision storage,
+  // modifications are then taken into account by fromFieldSet)
   fset.clear();
-  fset = util::shareFields(fset_);
+  if (geom_->singlePrecision()) {
+    materializeZero();
+    fset = copyFieldSetToDouble(fset_);
+  } else {
+    unshare();
+    fset = util::shareFields(fset_);
+    exported_ = true;
+  }
   for (auto field : fset) {
     field.metadata() = fset_[field.name()].metadata();
     if (!field.metadata().has("interp_type")) {
@@ -1005,9 +1557,25 @@ void Fields::fromFieldSet(const atlas::FieldSet & fset) {
   // Check input fieldset
   ASSERT(!fset.empty());
 
+  if (view_) {
+    if (fset.field_names() == fset_.field_names()) {
+      // Copy values into the ensemble member storage
+      Fields fields(*geom_, vars_, time_);
+      fields.fromFieldSet(fset);
+      *this = fields;
+      oops::Log::trace() << classname() << "::fromFieldSet done" << std::endl;
+      return;
+    } else {
+      // Different variables, detach from the ensemble
+      detachView();
+    }
+  }
+
   // Reset internal fieldset
-  fset_.clear();
+  releaseFields();
+  resetStorage();
   fset_ = util::shareFields(fset);
+  exported_ = true;
 
   // Reset variables
   vars_ = varns::Variables(fset_.field_names());
@@ -1015,6 +1583,9 @@ void Fields::fromFieldSet(const atlas::FieldSet & fset) {
     vars_[field.name()].setLevels(field.shape(1));
   }
 
+  // Convert storage precision if needed
+  convertFieldsPrecision();
+
   // Set duplicate points to the same value
   resetDuplicatePoints();
 
@@ -1034,9 +1605,41 @@ void Fields::synchronizeFields() {
 
 // -----------------------------------------------------------------------------
 
+bool Fields::compatibleWith(const Fields & other) const {
+  oops::Log::trace() << classname() << "::compatibleWith starting" << std::endl;
+
+  // Check geometry and number of variables (without applying pending zeros)
+  bool compatible = (geom_->id() == other.geom_->id()) && (vars_.size() == other.vars_.size());
+
+  // Check variables names and shapes
+  for (size_t jvar = 0; compatible && jvar < vars_.size(); ++jvar) {
+    const std::string & name = vars_[jvar].name();
+    compatible = (name == other.vars_[jvar].name()) && fset_.has(name) && other.fset_.has(name);
+    if (compatible) {
+      const atlas::Field field = fset_[name];
+      const atlas::Field fieldOther = other.fset_[name];
+      compatible = (field.rank() == fieldOther.rank()) && (field.shape() == fieldOther.shape());
+    }
+  }
+
+  oops::Log::trace() << classname() << "::compatibleWith done" << std::endl;
+  return compatible;
+}
+
+// -----------------------------------------------------------------------------
+
 void Fields::read(const eckit::Configuration & config) {
   oops::Log::trace() << classname() << "::read starting" << std::endl;
 
+  if (view_) {
+    // Read exclusive fields, then copy them into the ensemble member storage
+    Fields fields(*geom_, vars_, time_);
+    fields.read(config);
+    *this = fields;
+    oops::Log::trace() << classname() << "::read done" << std::endl;
+    return;
+  }
+
   // Update variables names
   varns::Variables vars_in_file;
   for (const auto & var : vars_) {
@@ -1068,13 +1671,25 @@ void Fields::read(const eckit::Configuration & config) {
       conf.set("latitude south to north", geom_->latSouthToNorth());
     }
 
-    // Read fieldset
+    // Read into double precision fields (all values overwritten, storage precision restored
+    // below)
+    atlas::FieldSet fset;
+    for (const auto & var : vars_in_file) {
+      atlas::Field field = geom_->functionSpace().createField<double>(
+        atlas::option::name(var.name()) | atlas::option::levels(var.getLevels()));
+      fset.add(field);
+    }
     util::readFieldSet(geom_->getComm(),
                        geom_->functionSpace(),
                        variableSizes,
                        vars_in_file.variables(),
                        conf,
-                       fset_);
+                       fset);
+
+    // Replace local fieldset
+    releaseFields();
+    resetStorage();
+    fset_ = fset;
   } else if (ioFormat == "grib") {
 #ifdef ECCODES_FOUND
     // GRIB format
@@ -1106,7 +1721,8 @@ void Fields::read(const eckit::Configuration & config) {
     }
 
     // Clear local fieldset
-    fset_.clear();
+    releaseFields();
+    resetStorage();
 
     // Create local fieldset
     for (const auto & var : vars_in_file) {
@@ -1228,7 +1844,8 @@ void Fields::read(const eckit::Configuration & config) {
     std::string ncFilePath = filepath + ".nc";
 
     // Clear local fieldset
-    fset_.clear();
+    releaseFields();
+    resetStorage();
 
     // Create local fieldset
     for (size_t jvar = 0; jvar < vars_in_file.size(); ++jvar) {
@@ -1336,6 +1953,9 @@ void Fields::read(const eckit::Configuration & config) {
     field.metadata().set("interp_type", "default");
   }
 
+  // Convert storage precision if needed
+  convertFieldsPrecision();
+
   oops::Log::trace() << classname() << "::read done" << std::endl;
 }
 
@@ -1345,7 +1965,8 @@ void Fields::write(const eckit::Configuration & config) const {
   oops::Log::trace() << classname() << "::write starting" << std::endl;
 
   // Copy fieldset
-  atlas::FieldSet fset = util::copyFieldSet(fset_);
+  materializeZero();
+  atlas::FieldSet fset = copyFieldSetToDouble(fset_);
 
   // Rename fields
   for (auto & field : fset) {
@@ -1402,8 +2023,19 @@ void Fields::write(const eckit::Configuration & config) const {
 // -----------------------------------------------------------------------------
 
 double Fields::norm() const {
-  oops::Log::trace() << classname() << "::norm" << std::endl;
-  return util::normFieldSet(fset_, vars_.variables(), geom_->getComm());
+  oops::Log::trace() << classname() << "::norm starting" << std::endl;
+
+  // Norm over all points, in double precision
+  materializeZero();
+  double zz = 0.0;
+  if (geom_->singlePrecision()) {
+    zz = util::normFieldSet(copyFieldSetToDouble(fset_), vars_.variables(), geom_->getComm());
+  } else {
+    zz = util::normFieldSet(fset_, vars_.variables(), geom_->getComm());
+  }
+
+  oops::Log::trace() << classname() << "::norm done" << std::endl;
+  return zz;
 }
 
 // -----------------------------------------------------------------------------
@@ -1411,6 +2043,16 @@ double Fields::norm() const {
 void Fields::print(std::ostream & os) const {
   oops::Log::trace() << classname() << "::print starting" << std::endl;
 
+  // Compute statistics (collective, so on all tasks whatever the output channel state)
+  const std::vector<FieldStatistics> stats = statistics(vars_);
+
+  // Skip formatting if the output channel is disabled on this task
+  const eckit::Channel * channel = dynamic_cast<const eckit::Channel *>(&os);
+  if (channel != nullptr && !*channel) {
+    oops::Log::trace() << classname() << "::print done" << std::endl;
+    return;
+  }
+
   os << std::endl;
   os << *geom_;
   std::string prefix;
@@ -1418,26 +2060,9 @@ void Fields::print(std::ostream & os) const {
     prefix = "Info     : ";
   }
   os << prefix << "Fields:";
-  const auto ghostView = atlas::array::make_view<int, 1>(geom_->functionSpace().ghost());
-  for (const auto & var : vars_) {
+  for (size_t jvar = 0; jvar < vars_.size(); ++jvar) {
     os << std::endl;
-    double zz = 0.0;
-    atlas::Field field = fset_[var.name()];
-    const std::string gmaskName = "gmask_" + std::to_string(geom_->groupIndex(var.name()));
-    const auto gmaskView = atlas::array::make_view<int, 2>(geom_->fields()[gmaskName]);
-    if (field.rank() == 2) {
-      auto view = atlas::array::make_view<double, 2>(field);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          if (gmaskView(jnode, jlevel) == 1 && ghostView(jnode) == 0) {
-            zz += view(jnode, jlevel)*view(jnode, jlevel);
-          }
-        }
-      }
-    }
-    geom_->getComm().allReduceInPlace(zz, eckit::mpi::sum());
-    zz = sqrt(zz);
-    os << prefix << "  " << var.name() << ": " << zz;
+    os << prefix << "  " << vars_[jvar].name() << ": " << std::sqrt(stats[jvar].sumSquares);
   }
 
   oops::Log::trace() << classname() << "::print done" << std::endl;
@@ -1465,15 +2090,17 @@ size_t Fields::serialSize() const {
 void Fields::serialize(std::vector<double> & vect)  const {
   oops::Log::trace() << classname() << "::serialize starting" << std::endl;
 
-  for (const auto & var : vars_) {
-    const atlas::Field field = fset_[var.name()];
-    if (field.rank() == 2) {
-      const auto view = atlas::array::make_view<double, 2>(field);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          vect.push_back(view(jnode, jlevel));
-        }
-      }
+  // Resize once, then copy each field storage as a contiguous block
+  size_t index = vect.size();
+  vect.resize(index+serialSize());
+  for (const auto & desc : descriptors()) {
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        const T * data = desc.dataAs<T>();
+        std::copy(data, data+desc.nnodes*desc.nlevs, vect.begin()+index);
+      });
+      index += desc.nnodes*desc.nlevs;
     }
   }
 
@@ -1486,16 +2113,18 @@ void Fields::deserialize(const std::vector<double> & vect,
                          size_t & index) {
   oops::Log::trace() << classname() << "::deserialize starting" << std::endl;
 
-  for (const auto & var : vars_) {
-    atlas::Field field = fset_[var.name()];
-    if (field.rank() == 2) {
-      auto view = atlas::array::make_view<double, 2>(field);
-      for (atlas::idx_t jnode = 0; jnode < field.shape(0); ++jnode) {
-        for (atlas::idx_t jlevel = 0; jlevel < field.shape(1); ++jlevel) {
-          view(jnode, jlevel) = vect[index];
-          ++index;
-        }
-      }
+  unshare(true);
+
+  // Copy contiguous blocks into each field storage
+  ASSERT(index+serialSize() <= vect.size());
+  for (const auto & desc : descriptors()) {
+    if (desc.field.rank() == 2) {
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        T * data = desc.dataAs<T>();
+        std::copy(vect.begin()+index, vect.begin()+index+desc.nnodes*desc.nlevs, data);
+      });
+      index += desc.nnodes*desc.nlevs;
     }
   }
 
@@ -1508,10 +2137,30 @@ eckit::Stream & operator<<(eckit::Stream & s,
                            const Fields & rhs) {
   oops::Log::trace() << "operator<< starting" << std::endl;
 
-  std::vector<double> vect;
-  rhs.serialize(vect);
-  for (auto & value : vect) {
-    s << value;
+  // Header: number of fields, then name, datatype kind, shape and dirty flag of each field
+  const std::vector<FieldDescriptor> & descs = rhs.descriptors();
+  size_t nfields = 0;
+  for (const auto & desc : descs) {
+    if (desc.field.rank() == 2) {
+      ++nfields;
+    }
+  }
+  s << nfields;
+  for (const auto & desc : descs) {
+    if (desc.field.rank() == 2) {
+      s << desc.name;
+      s << desc.field.datatype().kind();
+      s << desc.nnodes;
+      s << desc.nlevs;
+      s << desc.field.dirty();
+    }
+  }
+
+  // Data: one blob per field, in the storage precision
+  for (const auto & desc : descs) {
+    if (desc.field.rank() == 2) {
+      s.writeBlob(desc.data, desc.nnodes*desc.nlevs*desc.field.datatype().size());
+    }
   }
 
   oops::Log::trace() << "operator<< done" << std::endl;
@@ -1524,13 +2173,68 @@ eckit::Stream & operator>>(eckit::Stream & s,
                            Fields & rhs) {
   oops::Log::trace() << "operator>> starting" << std::endl;
 
-  std::vector<double> vect;
-  vect.resize(rhs.serialSize());
-  for (auto & value : vect) {
-      s >> value;
+  rhs.unshare(true);
+  std::vector<const FieldDescriptor *> descs;
+  for (const auto & desc : rhs.descriptors()) {
+    if (desc.field.rank() == 2) {
+      descs.push_back(&desc);
+    }
+  }
+
+  // Header
+  size_t nfields;
+  s >> nfields;
+  std::vector<int> kinds;
+  std::vector<bool> dirty;
+  for (size_t jfield = 0; jfield < nfields; ++jfield) {
+    std::string name;
+    int kind;
+    size_t nnodes;
+    size_t nlevs;
+    bool fieldDirty;
+    s >> name;
+    s >> kind;
+    s >> nnodes;
+    s >> nlevs;
+    s >> fieldDirty;
+    if (jfield >= descs.size() || name != descs[jfield]->name
+      || nnodes != descs[jfield]->nnodes || nlevs != descs[jfield]->nlevs) {
+      throw eckit::UserError("inconsistent field " + name + " in stream", Here());
+    }
+    kinds.push_back(kind);
+    dirty.push_back(fieldDirty);
+  }
+  if (nfields != descs.size()) {
+    throw eckit::UserError("inconsistent number of fields in stream", Here());
+  }
+
+  // Data
+  for (size_t jfield = 0; jfield < nfields; ++jfield) {
+    const FieldDescriptor & desc = *descs[jfield];
+    const size_t n = desc.nnodes*desc.nlevs;
+    if (kinds[jfield] == desc.field.datatype().kind()) {
+      // Same storage precision, read directly into the field
+      s.readBlob(desc.data, n*desc.field.datatype().size());
+    } else {
+      // Different storage precision, read into a buffer and convert
+      visitFieldStorage(desc.field, [&](auto tag) {
+        using T = decltype(tag);
+        T * data = desc.dataAs<T>();
+        if (kinds[jfield] == atlas::array::DataType::kind<double>()) {
+          std::vector<double> buffer(n);
+          s.readBlob(buffer.data(), n*sizeof(double));
+          std::copy(buffer.begin(), buffer.end(), data);
+        } else if (kinds[jfield] == atlas::array::DataType::kind<float>()) {
+          std::vector<float> buffer(n);
+          s.readBlob(buffer.data(), n*sizeof(float));
+          std::copy(buffer.begin(), buffer.end(), data);
+        } else {
+          throw eckit::NotImplemented("unsupported datatype in stream", Here());
+        }
+      });
+    }
+    desc.field.set_dirty(dirty[jfield]);
   }
-  size_t index = 0;
-  rhs.deserialize(vect, index);
 
   oops::Log::trace() << "operator>> done" << std::endl;
   return s;
@@ -1538,90 +2242,421 @@ eckit::Stream & operator>>(eckit::Stream & s,
 
 // -----------------------------------------------------------------------------
 
-std::vector<Interpolation>::iterator Fields::setupGridInterpolation(const Geometry & srcGeom)
-  const {
+atlas::Field Fields::createField(const std::string & name,
+                                const size_t & levels) const {
+  // Storage datatype
+  const atlas::array::DataType datatype = geom_->singlePrecision()
+    ? atlas::array::DataType::create<float>() : atlas::array::DataType::create<double>();
+
+  if (geom_->fieldPool()) {
+    // Recycle a field from the geometry pool
+    return geom_->fieldPool()->acquire(name, levels, datatype);
+  } else {
+    // Create a new field
+    return geom_->functionSpace().createField(atlas::option::name(name)
+      | atlas::option::levels(levels) | atlas::option::datatype(datatype));
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+atlas::FieldSet Fields::interpolationSource(const std::vector<std::string> & vars) const {
+  // Apply pending zero
+  materializeZero();
+
+  atlas::FieldSet fset;
+  for (const auto & var : vars) {
+    const atlas::Field field = fset_[var];
+    if (field.datatype().kind() == atlas::array::DataType::kind<double>()) {
+      // Share field
+      fset.add(field);
+    } else {
+      // Double precision scratch copy
+      atlas::Field fieldDouble;
+      if (geom_->fieldPool()) {
+        fieldDouble = geom_->fieldPool()->acquire(var, field.shape(1),
+          atlas::array::DataType::create<double>());
+      } else {
+        fieldDouble = geom_->functionSpace().createField<double>(atlas::option::name(var)
+          | atlas::option::levels(field.shape(1)));
+      }
+      fieldDouble.metadata() = field.metadata();
+      copyFieldData(field, fieldDouble);
+      fset.add(fieldDouble);
+    }
+  }
+  return fset;
+}
+
+// -----------------------------------------------------------------------------
+
+void Fields::releaseInterpolationSource(atlas::FieldSet & fset) const {
+  // Detach scratch copies
+  std::vector<atlas::Field> fields;
+  for (const auto & field : fset) {
+    if (!fset_.has(field.name()) || fset_[field.name()].get() != field.get()) {
+      fields.push_back(field);
+    }
+  }
+  fset = atlas::FieldSet();
+
+  if (geom_->fieldPool()) {
+    // Give scratch copies back to the pool
+    for (const auto & field : fields) {
+      geom_->fieldPool()->release(field);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void Fields::convertFieldsPrecision() {
+  // Storage datatype kind
+  const int kind = geom_->singlePrecision() ? atlas::array::DataType::kind<float>()
+    : atlas::array::DataType::kind<double>();
+
+  // Check whether a conversion is needed
+  bool convert = false;
+  for (const auto & field : fset_) {
+    convert = convert || (field.rank() == 2 && field.datatype().kind() != kind);
+  }
+
+  if (convert) {
+    // Rebuild fieldset, preserving fields order
+    atlas::FieldSet fset;
+    for (const auto & field : fset_) {
+      if (field.rank() == 2 && field.datatype().kind() != kind) {
+        atlas::Field fieldConverted = createField(field.name(), field.shape(1));
+        fieldConverted.metadata() = field.metadata();
+        copyFieldData(field, fieldConverted);
+        fset.add(fieldConverted);
+      } else {
+        fset.add(field);
+      }
+    }
+    fset.name() = fset_.name();
+    fset_ = fset;
+    descriptorsValid_ = false;
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void Fields::unshare(const bool overwrite) const {
+  if (storageToken_ && storageToken_.use_count() > 1) {
+    // Allocate exclusive fields
+    atlas::FieldSet fset;
+    for (const auto & field : fset_) {
+      atlas::Field fieldExclusive = createField(field.name(), field.shape(1));
+      fieldExclusive.metadata() = field.metadata();
+      if (!overwrite && !pendingZero_) {
+        copyFieldData(field, fieldExclusive);
+      }
+      fset.add(fieldExclusive);
+    }
+    fset.name() = fset_.name();
+    fset_ = fset;
+    storageToken_ = std::make_shared<int>(0);
+    exported_ = false;
+    descriptorsValid_ = false;
+  }
+
+  if (overwrite) {
+    // Values are about to be overwritten
+    pendingZero_ = false;
+  } else {
+    materializeZero();
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void Fields::materializeZero() const {
+  if (pendingZero_) {
+    for (auto field : fset_) {
+      if (field.rank() == 2) {
+        visitFieldStorage(field, [&](auto tag) {
+          using T = decltype(tag);
+          auto view = atlas::array::make_view<T, 2>(field);
+          view.assign(0.0);
+        });
+      }
+    }
+    fset_.set_dirty(false);
+    pendingZero_ = false;
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void Fields::resetStorage() {
+  storageToken_ = std::make_shared<int>(0);
+  pendingZero_ = false;
+  exported_ = false;
+  descriptorsValid_ = false;
+}
+
+// -----------------------------------------------------------------------------
+
+void Fields::releaseFields() {
+  // Detach fields
+  std::vector<atlas::Field> fields;
+  for (const auto & field : fset_) {
+    fields.push_back(field);
+  }
+  fset_ = atlas::FieldSet();
+  descriptors_.clear();
+  descriptorsValid_ = false;
+
+  if (geom_ && geom_->fieldPool() && !view_) {
+    // Give unshared fields back to the pool
+    for (const auto & field : fields) {
+      geom_->fieldPool()->release(field);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void Fields::detachView() {
+  if (view_) {
+    releaseFields();
+    view_ = false;
+    viewStorage_.clear();
+    resetStorage();
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+const std::vector<FieldDescriptor> & Fields::descriptors() const {
+  // Apply pending zero
+  materializeZero();
+
+  // Rebuild descriptors if necessary
+  if (!descriptorsValid_) {
+    descriptors_.clear();
+    for (const auto & var : vars_) {
+      FieldDescriptor desc;
+      desc.name = var.name();
+      desc.field = fset_[var.name()];
+      desc.data = nullptr;
+      desc.nnodes = 0;
+      desc.nlevs = 0;
+      if (desc.field.rank() == 2) {
+        visitFieldStorage(desc.field, [&](auto tag) {
+          using T = decltype(tag);
+          auto view = atlas::array::make_view<T, 2>(desc.field);
+          desc.data = view.data();
+          desc.nnodes = desc.field.shape(0);
+          desc.nlevs = desc.field.shape(1);
+        });
+      }
+      desc.groupIndex = geom_->groupIndex(var.name());
+      desc.gmaskSegments = &geom_->gmaskSegments(desc.groupIndex);
+      desc.gmaskOwnedSegments = &geom_->gmaskOwnedSegments(desc.groupIndex);
+      desc.gmaskNoGhostSegments = &geom_->gmaskNoGhostSegments(desc.groupIndex);
+      descriptors_.push_back(desc);
+    }
+    descriptorsValid_ = true;
+  }
+  return descriptors_;
+}
+
+// -----------------------------------------------------------------------------
+
+const FieldDescriptor & Fields::descriptor(const std::string & name) const {
+  for (const auto & desc : descriptors()) {
+    if (desc.name == name) {
+      return desc;
+    }
+  }
+  throw eckit::Exception("Variable " + name + " not found in fields", Here());
+}
+
+// -----------------------------------------------------------------------------
+
+const FieldDescriptor & Fields::descriptor(const size_t & jvar,
+                                           const std::string & name) const {
+  // Same variables ordering in most cases
+  const std::vector<FieldDescriptor> & descs = descriptors();
+  if (jvar < descs.size() && descs[jvar].name == name) {
+    return descs[jvar];
+  }
+  return descriptor(name);
+}
+
+// -----------------------------------------------------------------------------
+
+std::shared_ptr<Interpolation> Fields::setupGridInterpolation(const Geometry & srcGeom) const {
   oops::Log::trace() << classname() << "::setupGridInterpolation starting" << std::endl;
 
   // Get geometry UIDs (grid + "_" + paritioner)
   const std::string srcGeomUid = srcGeom.grid().uid() + "_" + srcGeom.partitioner().type();
   const std::string geomUid = geom_->grid().uid() + "_" + geom_->partitioner().type();
 
-  // Compare with existing UIDs
-  for (auto it = interpolations().begin(); it != interpolations().end(); ++it) {
-    if ((it->srcUid() == srcGeomUid) && (it->tgtUid() == geomUid)) {
-      oops::Log::trace() << classname() << "::setupGridInterpolation done" << std::endl;
-      return it;
-    }
+  // Look for an existing interpolation
+  std::shared_ptr<Interpolation> interpolation = InterpolationRegistry::instance().find(
+    srcGeomUid, geomUid);
+  if (interpolation) {
+    oops::Log::trace() << classname() << "::setupGridInterpolation done" << std::endl;
+    return interpolation;
   }
 
   // Create interpolation
-  Interpolation interpolation(srcGeom,
-                              srcGeomUid,
-                              geom_->grid(),
-                              geom_->functionSpace(),
-                              geomUid);
+  interpolation = std::make_shared<Interpolation>(srcGeom,
+                                                  srcGeomUid,
+                                                  geom_->grid(),
+                                                  geom_->functionSpace(),
+                                                  geomUid,
+                                                  true);
 
   // Insert new interpolation
-  interpolations().push_back(interpolation);
+  interpolation = InterpolationRegistry::instance().insert(interpolation, geom_->getComm());
 
   oops::Log::trace() << classname() << "::setupGridInterpolation done" << std::endl;
-  return std::prev(interpolations().end());
+  return interpolation;
 }
 
 // -----------------------------------------------------------------------------
 
-std::vector<Interpolation>::iterator Fields::setupObsInterpolation(const Locations & locs)
-  const {
+std::shared_ptr<Interpolation> Fields::setupObsInterpolation(const Locations & locs) const {
   oops::Log::trace() << classname() << "::setupObsInterpolation starting" << std::endl;
 
   // Get geometry UIDs (grid + "_" + paritioner)
   const std::string srcGeomUid = geom_->grid().uid() + "_" + geom_->partitioner().type();
   const std::string tgtObsUid = locs.grid().uid() + "_" + geom_->partitioner().type();
 
-  // Compare with existing UIDs
-  for (auto it = interpolations().begin(); it != interpolations().end(); ++it) {
-    if ((it->srcUid() == srcGeomUid) && (it->tgtUid() == tgtObsUid)) {
-      oops::Log::trace() << classname() << "::setupObsInterpolation done" << std::endl;
-      return it;
-    }
+  // Look for an existing interpolation
+  std::shared_ptr<Interpolation> interpolation = InterpolationRegistry::instance().find(
+    srcGeomUid, tgtObsUid);
+  if (interpolation) {
+    oops::Log::trace() << classname() << "::setupObsInterpolation done" << std::endl;
+    return interpolation;
   }
 
-  // New grid
-  const int nobsGlb = locs.grid().size();
+  // Create function space
+  std::unique_ptr<atlas::FunctionSpace> fspace;
 
-  // Define partition
-  std::vector<int> partition(nobsGlb);
-  size_t joGlb = 0;
-  for (size_t jt = 0; jt < geom_->getComm().size(); ++jt) {
-    for (int joOwn = 0; joOwn < locs.size(jt); ++joOwn) {
-      partition[joGlb] = jt;
-      ++joGlb;
+  if (geom_->interpolation().getString("interpolation type") != "atlas interpolation wrapper") {
+    // Create distributed observation function space (PointCloud of the local observations, no
+    // triangulation and no ghost points)
+    atlas::Field lonlat("lonlat", atlas::array::make_datatype<double>(),
+      atlas::array::make_shape(locs.size(), 2));
+    atlas::Field ghost("ghost", atlas::array::make_datatype<int>(),
+      atlas::array::make_shape(locs.size()));
+    auto lonlatView = atlas::array::make_view<double, 2>(lonlat);
+    auto ghostView = atlas::array::make_view<int, 1>(ghost);
+    for (int jo = 0; jo < locs.size(); ++jo) {
+      lonlatView(jo, 0) = locs[jo][0];
+      lonlatView(jo, 1) = locs[jo][1];
+      ghostView(jo) = 0;
+    }
+    fspace.reset(new atlas::functionspace::PointCloud(lonlat, ghost));
+  } else {
+    // The atlas interpolation wrapper needs a target function space matching the grid
+    // distribution
+    const int nobsGlb = locs.grid().size();
+
+    // Define partition
+    std::vector<int> partition(nobsGlb);
+    size_t joGlb = 0;
+    for (size_t jt = 0; jt < geom_->getComm().size(); ++jt) {
+      for (int joOwn = 0; joOwn < locs.size(jt); ++joOwn) {
+        partition[joGlb] = jt;
+        ++joGlb;
+      }
     }
-  }
 
-  // Create function space
-  std::unique_ptr<atlas::FunctionSpace> fspace;
+    if (nobsGlb > 3) {
+      // Create observation distribution
+      atlas::grid::Distribution distribution(geom_->getComm().size(), nobsGlb, &partition[0]);
 
-  if (nobsGlb > 3) {
-    // Create observation distribution
-    atlas::grid::Distribution distribution(geom_->getComm().size(), nobsGlb, &partition[0]);
+      // Create observation mesh
+      atlas::Mesh obsMesh = atlas::MeshGenerator("delaunay").generate(locs.grid(), distribution);
 
-    // Create observation mesh
-    atlas::Mesh obsMesh = atlas::MeshGenerator("delaunay").generate(locs.grid(), distribution);
+      // Create observation function space (NodeColumns)
+      fspace.reset(new atlas::functionspace::NodeColumns(obsMesh));
+    } else {
+      // Create observation function space (PointCloud)
+      fspace.reset(new atlas::functionspace::PointCloud(locs.grid()));
+    }
+  }
 
-    // Create observation function space (NodeColumns)
-    fspace.reset(new atlas::functionspace::NodeColumns(obsMesh));
-  } else {
-    // Create observation function space (PointCloud)
-    fspace.reset(new atlas::functionspace::PointCloud(locs.grid()));
+  // Observation keys, to reuse stencils across time slots for stationary observation networks
+  // (not for the atlas interpolation wrapper, whose target points are not the local observations)
+  const bool reuseStencils = geom_->interpolation().getBool("reuse observation stencils", false)
+    && geom_->interpolation().getString("interpolation type") != "atlas interpolation wrapper";
+  std::vector<uint64_t> obsKeys;
+  std::shared_ptr<Interpolation> parent;
+  std::vector<size_t> selection;
+  if (reuseStencils) {
+    obsKeys.resize(locs.size());
+    for (int jo = 0; jo < locs.size(); ++jo) {
+      obsKeys[jo] = locationKey(locs[jo]);
+    }
+
+    // Look for an interpolation covering all local observations, i.e. whose target locations
+    // are an exact bitwise superset of them. Candidates are sorted by target UID, so the parent
+    // does not depend on the registry usage history.
+    const std::vector<std::shared_ptr<Interpolation>> candidates
+      = InterpolationRegistry::instance().candidates(srcGeomUid);
+    const int notFound = std::numeric_limits<int>::max();
+    int index = notFound;
+    for (size_t jc = 0; jc < candidates.size(); ++jc) {
+      if (candidates[jc]->selectObservations(obsKeys, selection)) {
+        index = static_cast<int>(jc);
+        break;
+      }
+    }
+
+    // Reuse only if all tasks chose the same candidate, otherwise create a fresh interpolation
+    int indexMin = index;
+    int indexMax = index;
+    geom_->getComm().allReduceInPlace(indexMin, eckit::mpi::min());
+    geom_->getComm().allReduceInPlace(indexMax, eckit::mpi::max());
+    if ((indexMin == indexMax) && (index != notFound)) {
+      parent = candidates[index];
+    }
   }
 
   // Create horizontal interpolation
-  Interpolation interpolation(*geom_,
-                              srcGeomUid,
-                              locs.grid(),
-                              *fspace,
-                              tgtObsUid);
+  if (parent) {
+    interpolation = std::make_shared<Interpolation>(parent,
+                                                    selection,
+                                                    *fspace,
+                                                    tgtObsUid);
+  } else {
+    interpolation = std::make_shared<Interpolation>(*geom_,
+                                                    srcGeomUid,
+                                                    locs.grid(),
+                                                    *fspace,
+                                                    tgtObsUid);
+  }
+  if (reuseStencils) {
+    interpolation->setObservationKeys(obsKeys);
+  }
+
+  // Variables missing a vertical interpolation, per group
+  std::vector<std::vector<std::string>> missingVars(geom_->groups());
+  int nMissing = 0;
+  for (const auto & var : vars_.variables()) {
+    if (!interpolation->hasVerticalInterpolation(var)) {
+      missingVars[geom_->groupIndex(var)].push_back(var);
+      ++nMissing;
+    }
+  }
+  if (reuseStencils) {
+    // Vertical coordinate interpolated on all tasks if needed on any
+    geom_->getComm().allReduceInPlace(nMissing, eckit::mpi::max());
+  }
+  if (nMissing == 0) {
+    // Insert new interpolation
+    interpolation = InterpolationRegistry::instance().insert(interpolation, geom_->getComm());
+
+    oops::Log::trace() << classname() << "::setupObsInterpolation done" << std::endl;
+    return interpolation;
+  }
 
   // Interpolate vertical coordinate
   atlas::FieldSet fset;
@@ -1636,81 +2671,59 @@ std::vector<Interpolation>::iterator Fields::setupObsInterpolation(const Locatio
       fsetInterp.add(fieldInterp);
     }
   }
-  interpolation.execute(fset, fsetInterp);
+  interpolation->execute(fset, fsetInterp);
 
-  // Setup vertical interpolation
-  for (const auto & var : vars_.variables()) {
-    const std::string vertCoordName = "vert_coord_" + std::to_string(geom_->groupIndex(var));
-    const auto vert_coordView = atlas::array::make_view<double, 2>(fsetInterp[vertCoordName]);
-    std::vector<std::array<size_t, 2>> verStencil;
-    std::vector<std::array<double, 2>> verWeights;
-    std::vector<size_t> verStencilSize;
-    verStencil.resize(locs.size());
-    verWeights.resize(locs.size());
-    verStencilSize.resize(locs.size());
-    for (int jo = 0; jo < locs.size(); ++jo) {
-      if (geom_->levels(var) == 1) {
-        // No vertical interpolation
+  // Setup vertical interpolation, once per group
+  for (size_t groupIndex = 0; groupIndex < geom_->groups(); ++groupIndex) {
+    // Group variables
+    const std::vector<std::string> & groupVars = missingVars[groupIndex];
+    if (groupVars.empty()) {
+      continue;
+    }
+
+    // Stencils and weights
+    const size_t nlevs = geom_->levels(groupIndex);
+    std::vector<std::array<size_t, 2>> verStencil(locs.size());
+    std::vector<std::array<double, 2>> verWeights(locs.size());
+    std::vector<size_t> verStencilSize(locs.size());
+    if (nlevs == 1) {
+      // No vertical interpolation
+      for (int jo = 0; jo < locs.size(); ++jo) {
         verStencil[jo][0] = 0;
         verWeights[jo][0] = 1.0;
         verStencilSize[jo] = 1;
-      } else {
-        // Linear vertical interpolation
-        const double z = locs[jo][2];
-        double bottom = std::numeric_limits<double>::max();
-        double top = -std::numeric_limits<double>::max();
-        for (size_t k = 0; k < geom_->levels(var); ++k) {
-          bottom = std::min(bottom, vert_coordView(jo, k));
-          top = std::max(top, vert_coordView(jo, k));
-        }
-        ASSERT(z >= bottom);
-        ASSERT(z <= top);
-        double zinf = -std::numeric_limits<double>::max();
-        double zsup = std::numeric_limits<double>::max();
-        size_t kinf = 0;
-        size_t ksup = std::numeric_limits<size_t>::max();
-        for (size_t k = 0; k < geom_->levels(var); ++k) {
-          const double level = vert_coordView(jo, k);
-          if (level == z) {
-            zinf = level;
-            zsup = level;
-            kinf = k;
-            ksup = k;
-          } else {
-            if (z > level && zinf < level) {
-              zinf = level;
-              kinf = k;
-            }
-            if (z < level && zsup > level) {
-              zsup = level;
-              ksup = k;
-            }
-          }
-        }
-        if (kinf == ksup) {
-          verStencil[jo][0] = kinf;
-          verWeights[jo][0] = 1.0;
-          verStencilSize[jo] = 1;
-        } else {
-          verStencil[jo][0] = kinf;
-          verWeights[jo][0] = (zsup-z)/(zsup-zinf);
-          verStencil[jo][1] = ksup;
-          verWeights[jo][1] = (z-zinf)/(zsup-zinf);
-          verStencilSize[jo] = 2;
+      }
+    } else {
+      // Linear vertical interpolation
+      const std::string vertCoordName = "vert_coord_" + std::to_string(groupIndex);
+      const auto vert_coordView = atlas::array::make_view<double, 2>(fsetInterp[vertCoordName]);
+      const int direction = geom_->vert_coord_direction(groupIndex);
+      size_t nOutside = 0;
+      #pragma omp parallel for schedule(static) reduction(+:nOutside)
+      for (int jo = 0; jo < locs.size(); ++jo) {
+        if (!verticalStencil(&vert_coordView(jo, 0), nlevs, direction, locs[jo][2],
+          verStencil[jo], verWeights[jo], verStencilSize[jo])) {
+          ++nOutside;
         }
       }
+      if (nOutside > 0) {
+        throw eckit::Exception(std::to_string(nOutside)
+          + " observations outside of the vertical column", Here());
+      }
     }
-    interpolation.insertVerticalInterpolation(var,
-                                              verStencil,
-                                              verWeights,
-                                              verStencilSize);
+
+    // Insert vertical interpolation shared by all variables of the group
+    interpolation->insertVerticalInterpolation(groupVars,
+                                               verStencil,
+                                               verWeights,
+                                               verStencilSize);
   }
 
   // Insert new interpolation
-  interpolations().push_back(interpolation);
+  interpolation = InterpolationRegistry::instance().insert(interpolation, geom_->getComm());
 
   oops::Log::trace() << classname() << "::setupObsInterpolation done" << std::endl;
-  return std::prev(interpolations().end());
+  return interpolation;
 }
 
 // -----------------------------------------------------------------------------
@@ -1720,52 +2733,69 @@ void Fields::resetDuplicatePoints() {
 
   if (geom_->duplicatePoints()) {
     if (geom_->gridType() == "regular_lonlat") {
-      // Deal with poles
-      for (auto field_internal : fset_) {
-        // Get first longitude value
-        atlas::functionspace::StructuredColumns fs(field_internal.functionspace());
-        atlas::StructuredGrid grid = fs.grid();
-        auto view = atlas::array::make_view<double, 2>(field_internal);
-        auto view_i = atlas::array::make_view<int, 1>(fs.index_i());
-        auto view_j = atlas::array::make_view<int, 1>(fs.index_j());
-        std::vector<double> north(field_internal.shape(1), 0.0);
-        std::vector<double> south(field_internal.shape(1), 0.0);
-        for (atlas::idx_t j = fs.j_begin(); j < fs.j_end(); ++j) {
-          for (atlas::idx_t i = fs.i_begin(j); i < fs.i_end(j); ++i) {
-            atlas::idx_t jnode = fs.index(i, j);
-            if (view_i(jnode) == 1) {
-              if (view_j(jnode) == 1) {
-                for (atlas::idx_t jlevel = 0; jlevel < field_internal.shape(1); ++jlevel) {
-                  north[jlevel] = view(jnode, jlevel);
+      // Deal with poles, only on tasks holding pole nodes
+      const PoleData * poles = geom_->poles();
+      if (poles && poles->comm) {
+        // Fields to synchronize: all rank-2 fields, so that the buffer layout is identical on
+        // all pole tasks (the dirty flag is not guaranteed to be consistent across tasks)
+        std::vector<std::string> names;
+        for (const auto & field : fset_) {
+          if (field.rank() == 2) {
+            names.push_back(field.name());
+          }
+        }
+
+        if (!names.empty()) {
+          unshare();
+
+          // Pack first longitude values of all fields in a single buffer
+          size_t nlevsTot = 0;
+          for (const auto & name : names) {
+            nlevsTot += descriptor(name).nlevs;
+          }
+          std::vector<double> buffer(2*nlevsTot, 0.0);
+          size_t offset = 0;
+          for (const auto & name : names) {
+            const FieldDescriptor & desc = descriptor(name);
+            visitFieldStorage(desc.field, [&](auto tag) {
+              using T = decltype(tag);
+              const T * data = desc.dataAs<T>();
+              for (const auto & jnode : poles->north.ownedFirst) {
+                for (size_t jlevel = 0; jlevel < desc.nlevs; ++jlevel) {
+                  buffer[offset+jlevel] = data[jnode*desc.nlevs+jlevel];
                 }
               }
-              if (view_j(jnode) == grid.ny()) {
-                for (atlas::idx_t jlevel = 0; jlevel < field_internal.shape(1); ++jlevel) {
-                  south[jlevel] = view(jnode, jlevel);
+              for (const auto & jnode : poles->south.ownedFirst) {
+                for (size_t jlevel = 0; jlevel < desc.nlevs; ++jlevel) {
+                  buffer[nlevsTot+offset+jlevel] = data[jnode*desc.nlevs+jlevel];
                 }
               }
-            }
+            });
+            offset += desc.nlevs;
           }
-        }
 
-        // Reduce
-        geom_->getComm().allReduceInPlace(north.begin(), north.end(), eckit::mpi::sum());
-        geom_->getComm().allReduceInPlace(south.begin(), south.end(), eckit::mpi::sum());
-
-        // Copy value
-        for (atlas::idx_t j = fs.j_begin_halo(); j < fs.j_end_halo(); ++j) {
-          for (atlas::idx_t i = fs.i_begin_halo(j); i < fs.i_end_halo(j); ++i) {
-            atlas::idx_t jnode = fs.index(i, j);
-            if (view_j(jnode) == 1) {
-              for (atlas::idx_t jlevel = 0; jlevel < field_internal.shape(1); ++jlevel) {
-                view(jnode, jlevel) = north[jlevel];
+          // Reduce
+          poles->comm->allReduceInPlace(buffer.begin(), buffer.end(), eckit::mpi::sum());
+
+          // Copy values to all pole nodes
+          offset = 0;
+          for (const auto & name : names) {
+            const FieldDescriptor & desc = descriptor(name);
+            visitFieldStorage(desc.field, [&](auto tag) {
+              using T = decltype(tag);
+              T * data = desc.dataAs<T>();
+              for (const auto & jnode : poles->north.halo) {
+                for (size_t jlevel = 0; jlevel < desc.nlevs; ++jlevel) {
+                  data[jnode*desc.nlevs+jlevel] = buffer[offset+jlevel];
+                }
               }
-            }
-            if (view_j(jnode) == grid.ny()) {
-              for (atlas::idx_t jlevel = 0; jlevel < field_internal.shape(1); ++jlevel) {
-                view(jnode, jlevel) = south[jlevel];
+              for (const auto & jnode : poles->south.halo) {
+                for (size_t jlevel = 0; jlevel < desc.nlevs; ++jlevel) {
+                  data[jnode*desc.nlevs+jlevel] = buffer[nlevsTot+offset+jlevel];
+                }
               }
-            }
+            });
+            offset += desc.nlevs;
           }
         }
       }
@@ -1784,58 +2814,68 @@ void Fields::reduceDuplicatePoints() {
 
   if (geom_->duplicatePoints()) {
     if (geom_->gridType() == "regular_lonlat") {
-      // Deal with poles
-      for (auto field_internal : fset_) {
-        // Get local sums
-        atlas::functionspace::StructuredColumns fs(field_internal.functionspace());
-        atlas::StructuredGrid grid = fs.grid();
-        auto view = atlas::array::make_view<double, 2>(field_internal);
-        auto view_i = atlas::array::make_view<int, 1>(fs.index_i());
-        auto view_j = atlas::array::make_view<int, 1>(fs.index_j());
-        std::vector<double> north(field_internal.shape(1), 0.0);
-        std::vector<double> south(field_internal.shape(1), 0.0);
-        for (atlas::idx_t j = fs.j_begin(); j < fs.j_end(); ++j) {
-          for (atlas::idx_t i = fs.i_begin(j); i < fs.i_end(j); ++i) {
-            atlas::idx_t jnode = fs.index(i, j);
-            if (view_j(jnode) == 1) {
-              for (atlas::idx_t jlevel = 0; jlevel < field_internal.shape(1); ++jlevel) {
-                north[jlevel] += view(jnode, jlevel);
+      // Deal with poles, only on tasks holding pole nodes
+      const PoleData * poles = geom_->poles();
+      if (poles && poles->comm) {
+        unshare();
+
+        // Pack local sums of all fields in a single buffer
+        const std::vector<FieldDescriptor> & descs = descriptors();
+        size_t nlevsTot = 0;
+        for (const auto & desc : descs) {
+          nlevsTot += desc.nlevs;
+        }
+        std::vector<double> buffer(2*nlevsTot, 0.0);
+        size_t offset = 0;
+        for (const auto & desc : descs) {
+          if (desc.field.rank() == 2) {
+            visitFieldStorage(desc.field, [&](auto tag) {
+              using T = decltype(tag);
+              const T * data = desc.dataAs<T>();
+              for (const auto & jnode : poles->north.owned) {
+                for (size_t jlevel = 0; jlevel < desc.nlevs; ++jlevel) {
+                  buffer[offset+jlevel] += data[jnode*desc.nlevs+jlevel];
+                }
               }
-            }
-            if (view_j(jnode) == grid.ny()) {
-              for (atlas::idx_t jlevel = 0; jlevel < field_internal.shape(1); ++jlevel) {
-                south[jlevel] += view(jnode, jlevel);
+              for (const auto & jnode : poles->south.owned) {
+                for (size_t jlevel = 0; jlevel < desc.nlevs; ++jlevel) {
+                  buffer[nlevsTot+offset+jlevel] += data[jnode*desc.nlevs+jlevel];
+                }
               }
-            }
+            });
+            offset += desc.nlevs;
           }
         }
 
         // Reduce
-        geom_->getComm().allReduceInPlace(north.begin(), north.end(), eckit::mpi::sum());
-        geom_->getComm().allReduceInPlace(south.begin(), south.end(), eckit::mpi::sum());
-
-        // Copy value
-        for (atlas::idx_t j = fs.j_begin_halo(); j < fs.j_end_halo(); ++j) {
-          for (atlas::idx_t i = fs.i_begin_halo(j); i < fs.i_end_halo(j); ++i) {
-            atlas::idx_t jnode = fs.index(i, j);
-            if (view_i(jnode) == 1) {
-              if (view_j(jnode) == 1) {
-                for (atlas::idx_t jlevel = 0; jlevel < field_internal.shape(1); ++jlevel) {
-                  view(jnode, jlevel) = north[jlevel];
+        poles->comm->allReduceInPlace(buffer.begin(), buffer.end(), eckit::mpi::sum());
+
+        // Set sums on the first longitude, zero elsewhere
+        offset = 0;
+        for (const auto & desc : descs) {
+          if (desc.field.rank() == 2) {
+            visitFieldStorage(desc.field, [&](auto tag) {
+              using T = decltype(tag);
+              T * data = desc.dataAs<T>();
+              for (const PoleNodes * pole : {&poles->north, &poles->south}) {
+                for (const auto & jnode : pole->halo) {
+                  for (size_t jlevel = 0; jlevel < desc.nlevs; ++jlevel) {
+                    data[jnode*desc.nlevs+jlevel] = 0.0;
+                  }
                 }
               }
-              if (view_j(jnode) == grid.ny()) {
-                for (atlas::idx_t jlevel = 0; jlevel < field_internal.shape(1); ++jlevel) {
-                  view(jnode, jlevel) = south[jlevel];
+              for (const auto & jnode : poles->north.haloFirst) {
+                for (size_t jlevel = 0; jlevel < desc.nlevs; ++jlevel) {
+                  data[jnode*desc.nlevs+jlevel] = buffer[offset+jlevel];
                 }
               }
-            } else {
-              if ((view_j(jnode) == 1) || (view_j(jnode) == grid.ny())) {
-                for (atlas::idx_t jlevel = 0; jlevel < field_internal.shape(1); ++jlevel) {
-                  view(jnode, jlevel) = 0.0;
+              for (const auto & jnode : poles->south.haloFirst) {
+                for (size_t jlevel = 0; jlevel < desc.nlevs; ++jlevel) {
+                  data[jnode*desc.nlevs+jlevel] = buffer[nlevsTot+offset+jlevel];
                 }
               }
-            }
+            });
+            offset += desc.nlevs;
           }
         }
       }
@@ -19,6 +19,7 @@
 #include "atlas/mesh.h"
 #include "atlas/meshgenerator.h"
 
+#include "eckit/exception/Exceptions.h"
 #include "eckit/serialisation/Stream.h"
 
 #include "oops/util/DateTime.h"
@@ -26,13 +27,49 @@
 #include "oops/util/Printable.h"
 #include "oops/util/Serializable.h"
 
+#include "quenchxx/Geometry.h"
 #include "quenchxx/GeoVaLs.h"
 #include "quenchxx/Interpolation.h"
 #include "quenchxx/Locations.h"
 #include "quenchxx/VariablesSwitch.h"
 
 namespace quenchxx {
+  class EnsembleFields;
   class Geometry;
+  class Increment;
+
+// -----------------------------------------------------------------------------
+/// Field statistics on active points (ghost points excluded)
+
+struct FieldStatistics {
+  double min;
+  double max;
+  double sum;
+  double sumSquares;
+  size_t count;
+};
+
+// -----------------------------------------------------------------------------
+/// Field descriptor: cached handle, data pointer, shape, group and mask segments of a variable
+
+struct FieldDescriptor {
+  std::string name;
+  atlas::Field field;
+  void * data;
+  size_t nnodes;
+  size_t nlevs;
+  size_t groupIndex;
+  const MaskSegments * gmaskSegments;
+  const MaskSegments * gmaskOwnedSegments;
+  const MaskSegments * gmaskNoGhostSegments;
+
+  // Typed access to the field storage (float or double)
+  template <typename T>
+  T * dataAs() const {
+    ASSERT(field.datatype().kind() == atlas::array::DataType::kind<T>());
+    return static_cast<T *>(data);
+  }
+};
 
 // -----------------------------------------------------------------------------
 /// Fields class
@@ -53,8 +90,10 @@ class Fields : public util::Printable,
   Fields(const Fields &,
          const bool);
   Fields(const Fields &);
-  ~Fields()
-    {}
+  Fields(Fields &&);
+  Fields(EnsembleFields &,
+         const size_t &);
+  ~Fields();
 
   // Basic operators
   void zero();
@@ -62,12 +101,20 @@ class Fields : public util::Printable,
   void constantValue(const std::vector<double> &);
   void constantValue(const eckit::Configuration &);
   Fields & operator=(const Fields &);
+  Fields & operator=(Fields &&);
   Fields & operator+=(const Fields &);
   Fields & operator-=(const Fields &);
   Fields & operator*=(const double &);
   void axpy(const double &,
             const Fields &);
+  void axpby(const double &,
+             const double &,
+             const Fields &);
+  void linearCombination(const std::vector<double> &,
+                         const std::vector<const Fields*> &);
+  void ensembleMeanAndPerturbations(const std::vector<Fields*> &);
   double dot_product_with(const Fields &) const;
+  std::vector<double> dot_products_with(const std::vector<const Fields*> &) const;
   void schur_product_with(const Fields &);
   void dirac(const eckit::Configuration &);
   void random();
@@ -75,6 +122,7 @@ class Fields : public util::Printable,
             const Fields &);
   double min(const varns::Variables &) const;
   double max(const varns::Variables &) const;
+  std::vector<FieldStatistics> statistics(const varns::Variables &) const;
   void interpolate(const Locations &,
                    GeoVaLs &) const;
   void interpolateAD(const Locations &,
@@ -86,12 +134,13 @@ class Fields : public util::Printable,
   void toFieldSet(atlas::FieldSet &) const;
   void fromFieldSet(const atlas::FieldSet &);
   const atlas::FieldSet & fieldSet() const
-    {return fset_;}
+    {materializeZero(); return fset_;}
   atlas::FieldSet & fieldSet()
-    {return fset_;}
+    {unshare(); descriptorsValid_ = false; exported_ = true; return fset_;}
   void synchronizeFields();
 
   // Utilities
+  bool compatibleWith(const Fields &) const;
   void read(const eckit::Configuration &);
   void write(const eckit::Configuration &) const;
   double norm() const;
@@ -116,25 +165,72 @@ class Fields : public util::Printable,
   friend eckit::Stream & operator>>(eckit::Stream &,
                                     Fields &);
 
-  // Grid interpolations
-  static std::vector<quenchxx::Interpolation>& interpolations();
-
   // Duplicate points
   void resetDuplicatePoints();
 
  private:
+  // Ensemble storage and local increments write into the field buffers in place
+  friend class EnsembleFields;
+  friend class Increment;
+
+  // Fieldset with exclusive buffers, for in-place writes that do not export field handles
+  atlas::FieldSet & writableFieldSet()
+    {unshare(); return fset_;}
+
   // Print
   void print(std::ostream &) const;
 
   // Return grid interpolation
-  std::vector<quenchxx::Interpolation>::iterator setupGridInterpolation(const Geometry &) const;
+  std::shared_ptr<Interpolation> setupGridInterpolation(const Geometry &) const;
 
   // Return observations interpolation
-  std::vector<quenchxx::Interpolation>::iterator setupObsInterpolation(const Locations &) const;
+  std::shared_ptr<Interpolation> setupObsInterpolation(const Locations &) const;
 
   // Reduce duplicate points
   void reduceDuplicatePoints();
 
+  // Random fields: normal distribution drawn on the main task and scattered (default), or local
+  // counter-based generator independent of the MPI/OpenMP decomposition
+  void randomNormalDistribution();
+  void randomCounterBased();
+
+  // Local dot product (without reduction)
+  double localDotProductWith(const Fields &) const;
+
+  // Create a field, recycled from the geometry pool if available
+  atlas::Field createField(const std::string &,
+                           const size_t &) const;
+
+  // Convert fields to the geometry storage precision
+  void convertFieldsPrecision();
+
+  // Interpolation source: fields shared without copy for double precision storage, double
+  // precision scratch copies recycled through the geometry pool otherwise
+  atlas::FieldSet interpolationSource(const std::vector<std::string> &) const;
+  void releaseInterpolationSource(atlas::FieldSet &) const;
+
+  // Copy-on-write: make field buffers exclusive to this object, copying values unless they are
+  // about to be overwritten
+  void unshare(const bool overwrite = false) const;
+
+  // Lazy zero: zero field buffers if a zero is pending
+  void materializeZero() const;
+
+  // Reset storage state after the fieldset has been rebuilt
+  void resetStorage();
+
+  // Give fields back to the geometry pool
+  void releaseFields();
+
+  // Detach a view from the ensemble member storage
+  void detachView();
+
+  // Fields descriptors
+  const std::vector<FieldDescriptor> & descriptors() const;
+  const FieldDescriptor & descriptor(const std::string &) const;
+  const FieldDescriptor & descriptor(const size_t &,
+                                     const std::string &) const;
+
   // Geometry
   std::shared_ptr<const Geometry> geom_;
 
@@ -146,6 +242,27 @@ class Fields : public util::Printable,
 
   // Fieldset
   mutable atlas::FieldSet fset_;
+
+  // Fields descriptors, rebuilt when the fieldset changes
+  mutable std::vector<FieldDescriptor> descriptors_;
+  mutable bool descriptorsValid_;
+
+  // Copy-on-write token, shared by all Fields sharing the same field buffers
+  mutable std::shared_ptr<int> storageToken_;
+
+  // Pending zero, applied at first access to the field buffers
+  mutable bool pendingZero_;
+
+  // Field handles exported to a caller (toFieldSet, fromFieldSet or fieldSet), never shared by
+  // later copies since the caller can still modify them
+  mutable bool exported_;
+
+  // View on the storage of an ensemble member (not recycled in the pool, operations rebuilding
+  // the fieldset like read, random or fromFieldSet write into the member storage)
+  bool view_;
+
+  // Ensemble storage fields, kept alive as long as the view exists
+  std::vector<atlas::Field> viewStorage_;
 };
 
 // -----------------------------------------------------------------------------
@@ -10,7 +10,9 @@
 
 #include <netcdf.h>
 
+#include <atomic>
 #include <cmath>
+#include <map>
 #include <sstream>
 
 #include "atlas/field.h"
@@ -23,6 +25,8 @@
 
 #include "eckit/exception/Exceptions.h"
 #include "eckit/mpi/Comm.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/thread/Mutex.h"
 
 #include "oops/generic/gc99.h"
 #include "oops/util/FieldSetHelpers.h"
@@ -31,6 +35,7 @@
 
 #include "quenchxx/Fields.h"
 #include "quenchxx/GeometryIterator.h"
+#include "quenchxx/Utilities.h"
 
 #define ERR(e, msg) {std::string s(nc_strerror(e)); throw eckit::Exception(s + ": " + msg, Here());}
 
@@ -38,9 +43,16 @@ namespace quenchxx {
 
 // -----------------------------------------------------------------------------
 
+static std::atomic<size_t> geometryCounter(0);
+static eckit::Mutex geometryRegistryMutex;
+static std::map<size_t, std::weak_ptr<const Geometry>> geometryRegistry;
+
+// -----------------------------------------------------------------------------
+
 Geometry::Geometry(const eckit::Configuration & config,
                    const eckit::mpi::Comm & comm)
-  : comm_(comm), groups_() {
+  : comm_(comm), groups_(), id_(geometryCounter++), fieldPoolMaxBytes_(0),
+  singlePrecision_(false), counterBasedRandom_(false) {
   oops::Log::trace() << classname() << "::Geometry starting" << std::endl;
 
   GeometryParameters params;
@@ -111,6 +123,7 @@ Geometry::Geometry(const eckit::Configuration & config,
       groupsConfig[0].set("variables", vert_coordVars);
       groupsConfig[0].set("levels", 1);
       fileGeomConfig.set("groups", groupsConfig);
+      fileGeomConfig.set("single precision fields", false);
       Geometry fileGeom(fileGeomConfig);
       Fields field(fileGeom, vert_coordVar, util::DateTime());
       field.read(*vert_coordParamsFromFile);
@@ -171,6 +184,17 @@ Geometry::Geometry(const eckit::Configuration & config,
     }
     fields_->add(group.vert_coord_);
 
+    // Vertical coordinate direction shared by all local columns (0 if none)
+    group.vert_coord_direction_ = (group.vert_coord_.shape(0) > 0)
+      ? columnDirection(&vert_coordView(0, 0), group.levels_) : 0;
+    for (atlas::idx_t jnode = 1; jnode < group.vert_coord_.shape(0); ++jnode) {
+      if (columnDirection(&vert_coordView(jnode, 0), group.levels_)
+        != group.vert_coord_direction_) {
+        group.vert_coord_direction_ = 0;
+        break;
+      }
+    }
+
     // Default mask, set to 1 (true)
     const std::string gmaskName = "gmask_" + std::to_string(groupIndex);
     atlas::Field gmask = functionSpace_.createField<int>(
@@ -209,6 +233,10 @@ Geometry::Geometry(const eckit::Configuration & config,
       group.gmaskSize_ = group.gmaskSize_/static_cast<double>(domainSize);
     }
 
+    // Active points segments
+    setupMaskSegments(gmask, group.gmaskSegments_, group.gmaskOwnedSegments_,
+      group.gmaskNoGhostSegments_);
+
     // Save group
     groups_.push_back(group);
 
@@ -280,6 +308,9 @@ Geometry::Geometry(const eckit::Configuration & config,
   }
   comm_.allReduceInPlace(duplicatedPointsCount, eckit::mpi::sum());
   duplicatePoints_ = (duplicatedPointsCount > 0);
+  if (duplicatePoints_ && gridType_ == "regular_lonlat") {
+    setupPoles();
+  }
 
   // Iterator dimension
   iteratorDimension_ = config.getInt("iterator dimension", 2);
@@ -313,6 +344,18 @@ Geometry::Geometry(const eckit::Configuration & config,
     geomData_.reset(new oops::GeometryData(functionSpace_, fields_, levelsAreTopDown_, comm_));
   }
 
+  // Fields storage precision
+  singlePrecision_ = params.singlePrecision.value();
+
+  // Random fields generator
+  counterBasedRandom_ = params.counterBasedRandom.value();
+
+  // Field pool
+  fieldPoolMaxBytes_ = params.fieldPoolMaxBytes.value();
+  if (fieldPoolMaxBytes_ > 0) {
+    fieldPool_.reset(new FieldPool(functionSpace_, fieldPoolMaxBytes_));
+  }
+
   // Print summary
   this->print(oops::Log::info());
 
@@ -326,8 +369,11 @@ Geometry::Geometry(const Geometry & other)
   partitioner_(other.partitioner_), mesh_(other.mesh_), groupIndex_(other.groupIndex_),
   levelsAreTopDown_(other.levelsAreTopDown_), modelData_(other.modelData_), alias_(other.alias_),
   latSouthToNorth_(other.latSouthToNorth_), interpolation_(other.interpolation_),
-  duplicatePoints_(other.duplicatePoints_), iteratorDimension_(other.iteratorDimension_),
-  nnodes_(other.nnodes_), nlevs_(other.nlevs_), vert_coord_avg_(other.vert_coord_avg_) {
+  duplicatePoints_(other.duplicatePoints_), poles_(other.poles_),
+  iteratorDimension_(other.iteratorDimension_),
+  nnodes_(other.nnodes_), nlevs_(other.nlevs_), vert_coord_avg_(other.vert_coord_avg_),
+  id_(other.id_), fieldPoolMaxBytes_(other.fieldPoolMaxBytes_),
+  singlePrecision_(other.singlePrecision_), counterBasedRandom_(other.counterBasedRandom_) {
   oops::Log::trace() << classname() << "::Geometry starting" << std::endl;
 
   // Copy function space
@@ -371,9 +417,17 @@ Geometry::Geometry(const Geometry & other)
     // Copy averaged vertical coordinate
     group.vert_coord_avg_ = other.groups_[groupIndex].vert_coord_avg_;
 
+    // Copy vertical coordinate direction
+    group.vert_coord_direction_ = other.groups_[groupIndex].vert_coord_direction_;
+
     // Copy mask size
     group.gmaskSize_ = other.groups_[groupIndex].gmaskSize_;
 
+    // Copy active points segments
+    group.gmaskSegments_ = other.groups_[groupIndex].gmaskSegments_;
+    group.gmaskOwnedSegments_ = other.groups_[groupIndex].gmaskOwnedSegments_;
+    group.gmaskNoGhostSegments_ = other.groups_[groupIndex].gmaskNoGhostSegments_;
+
     // Save group
     groups_.push_back(group);
   }
@@ -383,11 +437,49 @@ Geometry::Geometry(const Geometry & other)
     geomData_.reset(new oops::GeometryData(functionSpace_, fields_, levelsAreTopDown_, comm_));
   }
 
+  // Field pool
+  if (fieldPoolMaxBytes_ > 0) {
+    fieldPool_.reset(new FieldPool(functionSpace_, fieldPoolMaxBytes_));
+  }
+
   oops::Log::trace() << classname() << "::Geometry done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
 
+std::shared_ptr<const Geometry> Geometry::shared(const Geometry & geom) {
+  oops::Log::trace() << classname() << "::shared starting" << std::endl;
+
+  eckit::AutoLock<eckit::Mutex> lock(geometryRegistryMutex);
+
+  // Remove expired geometries
+  for (auto it = geometryRegistry.begin(); it != geometryRegistry.end();) {
+    if (it->second.expired()) {
+      it = geometryRegistry.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // Look for an existing instance
+  std::shared_ptr<const Geometry> ptr;
+  const auto it = geometryRegistry.find(geom.id_);
+  if (it != geometryRegistry.end()) {
+    ptr = it->second.lock();
+  }
+
+  // Create and register a new instance
+  if (!ptr) {
+    ptr.reset(new Geometry(geom));
+    geometryRegistry[geom.id_] = ptr;
+  }
+
+  oops::Log::trace() << classname() << "::shared done" << std::endl;
+  return ptr;
+}
+
+// -----------------------------------------------------------------------------
+
 std::vector<size_t> Geometry::variableSizes(const varns::Variables & vars) const {
   oops::Log::trace() << classname() << "::variableSizes starting" << std::endl;
 
@@ -584,6 +676,118 @@ void Geometry::readSeaMask(const std::string & maskPath,
 
 // -----------------------------------------------------------------------------
 
+PoleData::~PoleData() {
+  if (comm) {
+    eckit::mpi::deleteComm(commName.c_str());
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void Geometry::setupPoles() {
+  oops::Log::trace() << classname() << "::setupPoles starting" << std::endl;
+
+  poles_.reset(new PoleData());
+
+  // Pole nodes
+  atlas::functionspace::StructuredColumns fs(functionSpace_);
+  atlas::StructuredGrid grid = fs.grid();
+  const auto view_i = atlas::array::make_view<int, 1>(fs.index_i());
+  const auto view_j = atlas::array::make_view<int, 1>(fs.index_j());
+  for (atlas::idx_t j = fs.j_begin(); j < fs.j_end(); ++j) {
+    for (atlas::idx_t i = fs.i_begin(j); i < fs.i_end(j); ++i) {
+      const atlas::idx_t jnode = fs.index(i, j);
+      for (PoleNodes * pole : {view_j(jnode) == 1 ? &poles_->north : nullptr,
+        view_j(jnode) == grid.ny() ? &poles_->south : nullptr}) {
+        if (pole) {
+          pole->owned.push_back(jnode);
+          if (view_i(jnode) == 1) {
+            pole->ownedFirst.push_back(jnode);
+          }
+        }
+      }
+    }
+  }
+  for (atlas::idx_t j = fs.j_begin_halo(); j < fs.j_end_halo(); ++j) {
+    for (atlas::idx_t i = fs.i_begin_halo(j); i < fs.i_end_halo(j); ++i) {
+      const atlas::idx_t jnode = fs.index(i, j);
+      for (PoleNodes * pole : {view_j(jnode) == 1 ? &poles_->north : nullptr,
+        view_j(jnode) == grid.ny() ? &poles_->south : nullptr}) {
+        if (pole) {
+          pole->halo.push_back(jnode);
+          if (view_i(jnode) == 1) {
+            pole->haloFirst.push_back(jnode);
+          }
+        }
+      }
+    }
+  }
+
+  // Split communicator (collective), only tasks holding pole nodes keep it
+  const bool hasPoles = !poles_->north.halo.empty() || !poles_->south.halo.empty();
+  const std::string commName = "quenchxx_poles_" + std::to_string(id_);
+  const eckit::mpi::Comm & comm = comm_.split(hasPoles ? 1 : 0, commName);
+  poles_->commName = commName;
+  poles_->comm = &comm;
+  if (!hasPoles) {
+    eckit::mpi::deleteComm(commName.c_str());
+    poles_->comm = nullptr;
+  }
+
+  oops::Log::trace() << classname() << "::setupPoles done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void Geometry::setupMaskSegments(const atlas::Field & gmask,
+                                 MaskSegments & gmaskSegments,
+                                 MaskSegments & gmaskOwnedSegments,
+                                 MaskSegments & gmaskNoGhostSegments) const {
+  oops::Log::trace() << classname() << "::setupMaskSegments starting" << std::endl;
+
+  // Append a point to the segments, extending the last segment if contiguous
+  // Segments length is bounded so that they can be shared among threads, and used as fixed
+  // reduction blocks (results do not depend on the number of threads)
+  const size_t maxSegmentSize = 4096;
+  const auto addPoint = [&maxSegmentSize](MaskSegments & segments, const size_t & jj) {
+    if (!segments.empty() && segments.back()[1] == jj
+      && segments.back()[1]-segments.back()[0] < maxSegmentSize) {
+      ++segments.back()[1];
+    } else {
+      segments.push_back({jj, jj+1});
+    }
+  };
+
+  // Build segments of active points (owned and non-ghost variants)
+  const auto gmaskView = atlas::array::make_view<int, 2>(gmask);
+  const auto ghostView = atlas::array::make_view<int, 1>(functionSpace_.ghost());
+  const auto ownedView = atlas::array::make_view<int, 2>(fields_.field("owned"));
+  gmaskSegments.clear();
+  gmaskOwnedSegments.clear();
+  gmaskNoGhostSegments.clear();
+  for (atlas::idx_t jnode = 0; jnode < gmask.shape(0); ++jnode) {
+    for (atlas::idx_t jlevel = 0; jlevel < gmask.shape(1); ++jlevel) {
+      if (gmaskView(jnode, jlevel) == 1) {
+        const size_t jj = static_cast<size_t>(jnode)*gmask.shape(1)+jlevel;
+        addPoint(gmaskSegments, jj);
+        if (ownedView(jnode, 0) == 1) {
+          addPoint(gmaskOwnedSegments, jj);
+        }
+        if (ghostView(jnode) == 0) {
+          addPoint(gmaskNoGhostSegments, jj);
+        }
+      }
+    }
+  }
+  gmaskSegments.shrink_to_fit();
+  gmaskOwnedSegments.shrink_to_fit();
+  gmaskNoGhostSegments.shrink_to_fit();
+
+  oops::Log::trace() << classname() << "::setupMaskSegments done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
 GeometryIterator Geometry::begin() const {
   return GeometryIterator(*this, 0, 0);
 }
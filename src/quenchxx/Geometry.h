@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -29,6 +30,7 @@
 #include "oops/util/parameters/RequiredParameter.h"
 #include "oops/util/Printable.h"
 
+#include "quenchxx/FieldPool.h"
 #include "quenchxx/VariablesSwitch.h"
 
 namespace eckit {
@@ -38,6 +40,41 @@ namespace eckit {
 namespace quenchxx {
   class GeometryIterator;
 
+// -----------------------------------------------------------------------------
+/// Active points segments: [begin, end) ranges of flat indices (jnode*levels+jlevel)
+
+typedef std::vector<std::array<size_t, 2>> MaskSegments;
+
+// -----------------------------------------------------------------------------
+/// Pole duplicate points of regular lon/lat grids, with a communicator restricted to the tasks
+/// holding pole nodes (including halo)
+
+struct PoleNodes {
+  // Owned nodes of the first longitude
+  std::vector<atlas::idx_t> ownedFirst;
+
+  // Owned nodes of all longitudes
+  std::vector<atlas::idx_t> owned;
+
+  // Nodes of the first longitude, including halo
+  std::vector<atlas::idx_t> haloFirst;
+
+  // Nodes of all longitudes, including halo
+  std::vector<atlas::idx_t> halo;
+};
+
+struct PoleData {
+  ~PoleData();
+
+  // North and south poles
+  PoleNodes north;
+  PoleNodes south;
+
+  // Communicator of the tasks holding pole nodes (nullptr on other tasks)
+  std::string commName;
+  const eckit::mpi::Comm * comm = nullptr;
+};
+
 // -----------------------------------------------------------------------------
 /// Orography parameters
 
@@ -116,6 +153,18 @@ class InterpolationParameters : public oops::Parameters {
  public:
   // Interpolation type
   oops::RequiredParameter<std::string> interpType{"interpolation type", this};
+
+  // Directory of the grid-to-grid interpolation weights cache
+  oops::OptionalParameter<std::string> weightsCacheDirectory{"weights cache directory", this};
+
+  // Extract the horizontal weights into a sparse operator applied by quenchxx (regional
+  // interpolation only)
+  oops::Parameter<bool> sparseOperator{"sparse operator", false, this};
+
+  // Reuse observation stencils across time slots when the local locations are an exact bitwise
+  // subset of the locations of an existing interpolation (matched by location hash, no tolerance:
+  // moving or rounded locations are not reused)
+  oops::Parameter<bool> reuseObsStencils{"reuse observation stencils", false, this};
 };
 
 // -----------------------------------------------------------------------------
@@ -158,6 +207,16 @@ class GeometryParameters : public oops::Parameters {
 
   // Interpolation parameters
   oops::OptionalParameter<InterpolationParameters> interpolation{"interpolation", this};
+
+  // Field pool maximum size in bytes (0 to disable)
+  oops::Parameter<size_t> fieldPoolMaxBytes{"field pool max bytes", 0, this};
+
+  // Single precision storage for fields (accumulations remain in double precision)
+  oops::Parameter<bool> singlePrecision{"single precision fields", false, this};
+
+  // Random fields from a local counter-based generator, independent of the MPI/OpenMP
+  // decomposition (but different from the default sequence)
+  oops::Parameter<bool> counterBasedRandom{"counter-based random fields", false, this};
 };
 
 // -----------------------------------------------------------------------------
@@ -174,6 +233,11 @@ class Geometry : public util::Printable,
            const eckit::mpi::Comm & comm = oops::mpi::world());
   Geometry(const Geometry &);
 
+  // Shared instance for a given geometry identity (copies share the identity)
+  static std::shared_ptr<const Geometry> shared(const Geometry &);
+  size_t id() const
+    {return id_;}
+
   // Variables sizes
   std::vector<size_t> variableSizes(const varns::Variables & vars) const;
   std::vector<size_t> variableSizes(const std::vector<std::string> &) const;
@@ -221,8 +285,24 @@ class Geometry : public util::Printable,
     {return eckit::mpi::self();}
   const std::vector<double> & vert_coord_avg(const std::string & var) const
     {return groups_[groupIndex_.at(var)].vert_coord_avg_;}
+  int vert_coord_direction(const size_t & groupIndex) const
+    {return groups_[groupIndex].vert_coord_direction_;}
+  const MaskSegments & gmaskSegments(const size_t & groupIndex) const
+    {return groups_[groupIndex].gmaskSegments_;}
+  const MaskSegments & gmaskOwnedSegments(const size_t & groupIndex) const
+    {return groups_[groupIndex].gmaskOwnedSegments_;}
+  const MaskSegments & gmaskNoGhostSegments(const size_t & groupIndex) const
+    {return groups_[groupIndex].gmaskNoGhostSegments_;}
   const oops::GeometryData & generic() const
     {return *geomData_;}
+  FieldPool * fieldPool() const
+    {return fieldPool_.get();}
+  const PoleData * poles() const
+    {return poles_.get();}
+  bool singlePrecision() const
+    {return singlePrecision_;}
+  bool counterBasedRandom() const
+    {return counterBasedRandom_;}
 
   // Geometry iterator
   GeometryIterator begin() const;
@@ -245,6 +325,15 @@ class Geometry : public util::Printable,
                    const std::string &,
                    atlas::Field &) const;
 
+  // Setup pole duplicate points
+  void setupPoles();
+
+  // Setup active points segments
+  void setupMaskSegments(const atlas::Field &,
+                         MaskSegments &,
+                         MaskSegments &,
+                         MaskSegments &) const;
+
   // Communicator
   const eckit::mpi::Comm & comm_;
 
@@ -275,7 +364,11 @@ class Geometry : public util::Printable,
     std::string lev2d_;
     atlas::Field vert_coord_;
     std::vector<double> vert_coord_avg_;
+    int vert_coord_direction_;
     double gmaskSize_;
+    MaskSegments gmaskSegments_;
+    MaskSegments gmaskOwnedSegments_;
+    MaskSegments gmaskNoGhostSegments_;
   };
 
   // Geometry fields
@@ -301,6 +394,7 @@ class Geometry : public util::Printable,
 
   // Duplicate points
   bool duplicatePoints_;
+  std::shared_ptr<PoleData> poles_;
 
   // Geometry iterator
   size_t iteratorDimension_;
@@ -310,6 +404,19 @@ class Geometry : public util::Printable,
 
   // Geometry data structure
   std::unique_ptr<oops::GeometryData> geomData_;
+
+  // Geometry identity
+  size_t id_;
+
+  // Field pool
+  size_t fieldPoolMaxBytes_;
+  std::unique_ptr<FieldPool> fieldPool_;
+
+  // Fields storage precision
+  bool singlePrecision_;
+
+  // Counter-based random fields
+  bool counterBasedRandom_;
 };
 
 // -----------------------------------------------------------------------------
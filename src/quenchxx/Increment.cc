@@ -8,12 +8,15 @@
 
 #include "quenchxx/Increment.h"
 
+#include <utility>
 #include <vector>
 
 #include "atlas/field.h"
 
 #include "oops/util/Logger.h"
 
+#include "quenchxx/Utilities.h"
+
 namespace quenchxx {
 
 // -----------------------------------------------------------------------------
@@ -65,6 +68,21 @@ Increment::Increment(const Increment & other,
 
 // -----------------------------------------------------------------------------
 
+Increment::Increment(Increment && other)
+  : fields_(std::move(other.fields_)) {
+  oops::Log::trace() << classname() << "::Increment" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+Increment::Increment(EnsembleFields & ens,
+                     const size_t & member)
+  : fields_(new Fields(ens, member)) {
+  oops::Log::trace() << classname() << "::Increment" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
 void Increment::diff(const State & x1,
                      const State & x2) {
   oops::Log::trace() << classname() << "::diff starting" << std::endl;
@@ -81,7 +99,24 @@ void Increment::diff(const State & x1,
 Increment & Increment::operator=(const Increment & rhs) {
   oops::Log::trace() << classname() << "::operator= starting" << std::endl;
 
-  fields_.reset(new Fields(*rhs.fields_));
+  if (fields_ && fields_->compatibleWith(*rhs.fields_)) {
+    // Copy into existing fields
+    *fields_ = *rhs.fields_;
+  } else {
+    // Reallocate fields
+    fields_.reset(new Fields(*rhs.fields_));
+  }
+
+  oops::Log::trace() << classname() << "::operator= done" << std::endl;
+  return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+Increment & Increment::operator=(Increment && rhs) {
+  oops::Log::trace() << classname() << "::operator= starting" << std::endl;
+
+  fields_ = std::move(rhs.fields_);
 
   oops::Log::trace() << classname() << "::operator= done" << std::endl;
   return *this;
@@ -148,6 +183,65 @@ void Increment::axpy(const double & zz,
 
 // -----------------------------------------------------------------------------
 
+void Increment::axpby(const double & zz1,
+                      const double & zz2,
+                      const Increment & dx,
+                      const bool check) {
+  oops::Log::trace() << classname() << "::axpby starting" << std::endl;
+
+  ASSERT(!check || this->validTime() == dx.validTime());
+  fields_->axpby(zz1, zz2, *dx.fields_);
+
+  oops::Log::trace() << classname() << "::axpby done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void Increment::linearCombination(const std::vector<double> & coeffs,
+                                  const std::vector<const Increment*> & dxs) {
+  oops::Log::trace() << classname() << "::linearCombination starting" << std::endl;
+
+  std::vector<const Fields*> members;
+  for (const auto & dx : dxs) {
+    members.push_back(dx->fields_.get());
+  }
+  fields_->linearCombination(coeffs, members);
+
+  oops::Log::trace() << classname() << "::linearCombination done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void Increment::ensembleMeanAndPerturbations(const std::vector<Increment*> & dxs) {
+  oops::Log::trace() << classname() << "::ensembleMeanAndPerturbations starting" << std::endl;
+
+  std::vector<Fields*> members;
+  for (const auto & dx : dxs) {
+    ASSERT(this->validTime() == dx->validTime());
+    members.push_back(dx->fields_.get());
+  }
+  fields_->ensembleMeanAndPerturbations(members);
+
+  oops::Log::trace() << classname() << "::ensembleMeanAndPerturbations done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+std::vector<double> Increment::dot_products_with(const std::vector<const Increment*> & dxs) const {
+  oops::Log::trace() << classname() << "::dot_products_with starting" << std::endl;
+
+  std::vector<const Fields*> others;
+  for (const auto & dx : dxs) {
+    others.push_back(dx->fields_.get());
+  }
+  const std::vector<double> zz = fields_->dot_products_with(others);
+
+  oops::Log::trace() << classname() << "::dot_products_with done" << std::endl;
+  return zz;
+}
+
+// -----------------------------------------------------------------------------
+
 eckit::Stream & operator<<(eckit::Stream & s,
                            const Increment & dx) {
   oops::Log::trace() << "Increment::operator<< starting" << std::endl;
@@ -182,11 +276,15 @@ oops::LocalIncrement Increment::getLocal(const GeometryIterator & geometryIterat
     size_t valuesSize = std::accumulate(variableSizes.begin(), variableSizes.end(), 0);
     std::vector<double> values(valuesSize);
     for (const auto & var : this->variables()) {
-      const auto view = atlas::array::make_view<double, 2>(this->fields().fieldSet()[var.name()]);
-      for (size_t jlevel = 0; jlevel < var.getLevels(); ++jlevel) {
-        values[index] = view(geometryIterator.jnode(), jlevel);
-        ++index;
-      }
+      const atlas::Field field = this->fields().fieldSet()[var.name()];
+      visitFieldStorage(field, [&](auto tag) {
+        using T = decltype(tag);
+        const auto view = atlas::array::make_view<const T, 2>(field);
+        for (size_t jlevel = 0; jlevel < var.getLevels(); ++jlevel) {
+          values[index] = view(geometryIterator.jnode(), jlevel);
+          ++index;
+        }
+      });
     }
     return oops::LocalIncrement(this->variables(), values, variableSizes);
   } else {
@@ -194,8 +292,12 @@ oops::LocalIncrement Increment::getLocal(const GeometryIterator & geometryIterat
     size_t valuesSize = this->variables().size();
     std::vector<double> values(valuesSize);
     for (const auto & var : this->variables()) {
-      const auto view = atlas::array::make_view<double, 2>(this->fields().fieldSet()[var.name()]);
-      values[index] = view(geometryIterator.jnode(), geometryIterator.jlevel());
+      const atlas::Field field = this->fields().fieldSet()[var.name()];
+      visitFieldStorage(field, [&](auto tag) {
+        using T = decltype(tag);
+        const auto view = atlas::array::make_view<const T, 2>(field);
+        values[index] = view(geometryIterator.jnode(), geometryIterator.jlevel());
+      });
       ++index;
     }
     return oops::LocalIncrement(this->variables(), values, variableSizes);
@@ -207,19 +309,28 @@ oops::LocalIncrement Increment::getLocal(const GeometryIterator & geometryIterat
 void Increment::setLocal(const oops::LocalIncrement & localIncrement,
                          const GeometryIterator & geometryIterator) {
   std::vector<double> values = localIncrement.getVals();
+  atlas::FieldSet & fset = this->fields().writableFieldSet();
   size_t index = 0;
   if (this->geometry()->iteratorDimension() == 2) {
     for (const auto & var : this->variables()) {
-      auto view = atlas::array::make_view<double, 2>(this->fields().fieldSet()[var.name()]);
-      for (size_t jlevel = 0; jlevel < var.getLevels(); ++jlevel) {
-        view(geometryIterator.jnode(), jlevel) = values[index];
-        ++index;
-      }
+      atlas::Field field = fset[var.name()];
+      visitFieldStorage(field, [&](auto tag) {
+        using T = decltype(tag);
+        auto view = atlas::array::make_view<T, 2>(field);
+        for (size_t jlevel = 0; jlevel < var.getLevels(); ++jlevel) {
+          view(geometryIterator.jnode(), jlevel) = values[index];
+          ++index;
+        }
+      });
     }
   } else {
     for (const auto & var : this->variables()) {
-      auto view = atlas::array::make_view<double, 2>(this->fields().fieldSet()[var.name()]);
-      view(geometryIterator.jnode(), geometryIterator.jlevel()) = values[index];
+      atlas::Field field = fset[var.name()];
+      visitFieldStorage(field, [&](auto tag) {
+        using T = decltype(tag);
+        auto view = atlas::array::make_view<T, 2>(field);
+        view(geometryIterator.jnode(), geometryIterator.jlevel()) = values[index];
+      });
       ++index;
     }
   }
@@ -25,6 +25,7 @@
 
 #include "oops/base/LocalIncrement.h"
 
+#include "quenchxx/EnsembleFields.h"
 #include "quenchxx/Fields.h"
 #include "quenchxx/GeometryIterator.h"
 #include "quenchxx/State.h"
@@ -55,6 +56,9 @@ class Increment : public util::Printable,
             const Increment &);
   Increment(const Increment &,
             const bool);
+  Increment(Increment &&);
+  Increment(EnsembleFields &,
+            const size_t &);
 
   // Basic operators
   void diff(const State &,
@@ -67,14 +71,23 @@ class Increment : public util::Printable,
   void dirac(const eckit::Configuration & config)
     {fields_->dirac(config);}
   Increment & operator =(const Increment &);
+  Increment & operator=(Increment &&);
   Increment & operator+=(const Increment &);
   Increment & operator-=(const Increment &);
   Increment & operator*=(const double &);
   void axpy(const double &,
             const Increment &,
             const bool check = true);
+  void axpby(const double &,
+             const double &,
+             const Increment &,
+             const bool check = true);
+  void linearCombination(const std::vector<double> &,
+                         const std::vector<const Increment*> &);
+  void ensembleMeanAndPerturbations(const std::vector<Increment*> &);
   double dot_product_with(const Increment & dx) const
     {return fields_->dot_product_with(*dx.fields_);}
+  std::vector<double> dot_products_with(const std::vector<const Increment*> &) const;
   void schur_product_with(const Increment & dx)
     {fields_->schur_product_with(*dx.fields_);}
   void random()
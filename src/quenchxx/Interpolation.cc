@@ -7,9 +7,17 @@
 
 #include "quenchxx/Interpolation.h"
 
+#include <algorithm>
+#include <string>
+#include <utility>
+
 #include "atlas/array.h"
+#include "atlas/interpolation/Cache.h"
 
 #include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/linalg/SparseMatrix.h"
+#include "eckit/mpi/Comm.h"
 
 #include "oops/util/FieldSetHelpers.h"
 
@@ -25,8 +33,10 @@ Interpolation::Interpolation(const Geometry & geom,
                              const std::string & srcUid,
                              const atlas::Grid & tgtGrid,
                              const atlas::FunctionSpace & tgtFspace,
-                             const std::string & tgtUid)
-  : srcUid_(srcUid), tgtUid_(tgtUid), tgtFspace_(tgtFspace) {
+                             const std::string & tgtUid,
+                             const bool cacheWeights)
+  : srcUid_(srcUid), tgtUid_(tgtUid), tgtFspace_(tgtFspace), horizontalBytes_(0),
+  weightsFromCache_(false), sparseOperator_(false), tgtGhost_(false), obsKeysSet_(false) {
   oops::Log::trace() << classname() << "::Interpolation starting" << std::endl;
 
   // Get interpolation type
@@ -36,10 +46,61 @@ Interpolation::Interpolation(const Geometry & geom,
   if (type == "atlas interpolation wrapper") {
     atlasInterpWrapper_ = std::make_shared<saber::interpolation::AtlasInterpWrapper>(
       geom.partitioner(), geom.functionSpace(), tgtGrid, tgtFspace_);
+    if (cacheWeights && geom.interpolation().has("weights cache directory")) {
+      oops::Log::info() << "Info     : weights cache not available for atlas interpolation wrapper"
+        << std::endl;
+    }
   } else if (type == "regional") {
-    regionalInterp_ = std::make_shared<atlas::Interpolation>(
-      atlas::util::Config("type", "regional-linear-2d"),
-      geom.functionSpace(), tgtFspace_);
+    const atlas::util::Config interpConfig("type", "regional-linear-2d");
+
+    // Weights cache file, specific to the grids, partitioners, number of tasks and task
+    std::string cacheFile;
+    if (cacheWeights && geom.interpolation().has("weights cache directory")) {
+      const std::string cacheDir = geom.interpolation().getString("weights cache directory");
+      eckit::PathName(cacheDir).mkdir();
+      cacheFile = cacheDir + "/" + srcUid_ + "-" + tgtUid_ + "-np"
+        + std::to_string(geom.getComm().size()) + "-rank" + std::to_string(geom.getComm().rank())
+        + ".mat";
+    }
+
+    // Read weights from the cache
+    eckit::linalg::SparseMatrix matrix;
+    int cacheAvailable = 0;
+    if (!cacheFile.empty() && eckit::PathName(cacheFile).exists()) {
+      matrix.load(cacheFile);
+      if (matrix.rows() == static_cast<size_t>(tgtFspace_.size())
+        && matrix.cols() == static_cast<size_t>(geom.functionSpace().size())) {
+        cacheAvailable = 1;
+      } else {
+        oops::Log::warning() << "Warning  : inconsistent weights cache file " << cacheFile
+          << ", weights are recomputed" << std::endl;
+      }
+    }
+
+    // Use the cache only if available on all tasks, since computing the weights is collective
+    if (!cacheFile.empty()) {
+      geom.getComm().allReduceInPlace(cacheAvailable, eckit::mpi::min());
+    }
+    if (cacheAvailable == 1) {
+      const atlas::interpolation::MatrixCache cache(std::move(matrix));
+      regionalInterp_ = std::make_shared<atlas::Interpolation>(interpConfig,
+        geom.functionSpace(), tgtFspace_, cache);
+      weightsFromCache_ = true;
+    }
+
+    if (!regionalInterp_) {
+      // Compute weights
+      regionalInterp_ = std::make_shared<atlas::Interpolation>(interpConfig,
+        geom.functionSpace(), tgtFspace_);
+
+      // Write weights to the cache (temporary file renamed for concurrent runs)
+      if (!cacheFile.empty()) {
+        const atlas::interpolation::MatrixCache cache(*regionalInterp_);
+        const eckit::PathName tmpFile(cacheFile + ".tmp");
+        cache.matrix().save(tmpFile);
+        eckit::PathName::rename(tmpFile, eckit::PathName(cacheFile));
+      }
+    }
   } else if (type == "unstructured") {
     // Get longitudes/latitudes
     std::vector<double> lons;
@@ -57,19 +118,214 @@ Interpolation::Interpolation(const Geometry & geom,
     // Setup unstructured interpolator
     unstructuredInterp_ = std::make_shared<oops::UnstructuredInterpolator>(geom.interpolation(),
       geom.generic(), lats, lons);
+    if (cacheWeights && geom.interpolation().has("weights cache directory")) {
+      oops::Log::info() << "Info     : weights cache not available for unstructured interpolation"
+        << std::endl;
+    }
   } else {
     throw eckit::Exception("wrong interpolation type", Here());
   }
 
+  // Horizontal interpolation footprint: one index and one weight per neighbour and target point
+  const size_t nneighbours = geom.interpolation().getInt("nnearest", 4);
+  horizontalBytes_ = tgtFspace_.size()*nneighbours*(sizeof(size_t)+sizeof(double));
+
+  // Extract the horizontal weights into a sparse operator
+  if (geom.interpolation().getBool("sparse operator", false)) {
+    if (atlasInterpWrapper_) {
+      oops::Log::info() << "Info     : sparse operator not available for atlas interpolation "
+        << "wrapper" << std::endl;
+    } else if (unstructuredInterp_) {
+      // The unstructured interpolator does not expose its stencils, and probing it costs one
+      // application per block of source points
+      oops::Log::info() << "Info     : sparse operator not available for unstructured "
+        << "interpolation" << std::endl;
+    } else {
+      setupSparseOperator(geom);
+    }
+  }
+
   oops::Log::trace() << classname() << "::Interpolation done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
 
-void Interpolation::execute(const atlas::FieldSet & srcFieldSet,
+Interpolation::Interpolation(const std::shared_ptr<const Interpolation> & parent,
+                             const std::vector<size_t> & selection,
+                             const atlas::FunctionSpace & tgtFspace,
+                             const std::string & tgtUid)
+  : srcUid_(parent->srcUid_), tgtUid_(tgtUid), tgtFspace_(tgtFspace), horizontalBytes_(0),
+  weightsFromCache_(false), sparseOperator_(false), tgtGhost_(false), obsKeysSet_(false),
+  parent_(parent), selection_(selection) {
+  oops::Log::trace() << classname() << "::Interpolation starting" << std::endl;
+
+  // Select from the root interpolation directly
+  if (parent_->parent_) {
+    for (auto & jsel : selection_) {
+      jsel = parent_->selection_[jsel];
+    }
+    parent_ = parent_->parent_;
+  }
+  ASSERT(selection_.size() == static_cast<size_t>(tgtFspace_.size()));
+
+  // Copy selected rows of the sparse horizontal operator
+  if (parent_->sparseOperator_) {
+    const CsrMatrix & parentOp = parent_->horOperator_;
+    horOperator_.rowPtr.resize(selection_.size()+1);
+    horOperator_.rowPtr[0] = 0;
+    for (size_t jo = 0; jo < selection_.size(); ++jo) {
+      horOperator_.rowPtr[jo+1] = horOperator_.rowPtr[jo]+parentOp.rowPtr[selection_[jo]+1]
+        -parentOp.rowPtr[selection_[jo]];
+    }
+    horOperator_.colIndex.resize(horOperator_.rowPtr.back());
+    horOperator_.values.resize(horOperator_.rowPtr.back());
+    for (size_t jo = 0; jo < selection_.size(); ++jo) {
+      std::copy(parentOp.colIndex.begin()+parentOp.rowPtr[selection_[jo]],
+        parentOp.colIndex.begin()+parentOp.rowPtr[selection_[jo]+1],
+        horOperator_.colIndex.begin()+horOperator_.rowPtr[jo]);
+      std::copy(parentOp.values.begin()+parentOp.rowPtr[selection_[jo]],
+        parentOp.values.begin()+parentOp.rowPtr[selection_[jo]+1],
+        horOperator_.values.begin()+horOperator_.rowPtr[jo]);
+    }
+    setupSparseTranspose(parent_->horOperatorT_.rowPtr.size()-1);
+    sparseOperator_ = true;
+    horizontalBytes_ = (horOperator_.rowPtr.size()+horOperatorT_.rowPtr.size())*sizeof(size_t)
+      +2*horOperator_.values.size()*(sizeof(size_t)+sizeof(double));
+  }
+  horizontalBytes_ += selection_.size()*sizeof(size_t);
+
+  // Copy selected rows of the vertical operators
+  for (const auto & parentOp : parent_->verOperators_) {
+    CsrMatrix op;
+    op.rowPtr.resize(selection_.size()+1);
+    op.rowPtr[0] = 0;
+    for (size_t jo = 0; jo < selection_.size(); ++jo) {
+      const size_t jbegin = parentOp.rowPtr[selection_[jo]];
+      const size_t jend = parentOp.rowPtr[selection_[jo]+1];
+      op.rowPtr[jo+1] = op.rowPtr[jo]+jend-jbegin;
+      op.colIndex.insert(op.colIndex.end(), parentOp.colIndex.begin()+jbegin,
+        parentOp.colIndex.begin()+jend);
+      op.values.insert(op.values.end(), parentOp.values.begin()+jbegin,
+        parentOp.values.begin()+jend);
+    }
+    verOperators_.push_back(std::move(op));
+  }
+  verOperatorIndex_ = parent_->verOperatorIndex_;
+
+  oops::Log::trace() << classname() << "::Interpolation done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void Interpolation::execute(atlas::FieldSet & srcFieldSet,
                             atlas::FieldSet & tgtFieldSet) const {
   oops::Log::trace() << classname() << "::execute starting" << std::endl;
 
+  if (sparseOperator_) {
+    // Split fields between the sparse operator and the backend
+    atlas::FieldSet srcSparse;
+    atlas::FieldSet tgtSparse;
+    atlas::FieldSet srcBackend;
+    atlas::FieldSet tgtBackend;
+    for (const auto & tgtField : tgtFieldSet) {
+      const atlas::Field srcField = srcFieldSet[tgtField.name()];
+      if (srcField.metadata().getString("interp_type", "default") == "default") {
+        srcSparse.add(srcField);
+        tgtSparse.add(tgtField);
+      } else {
+        srcBackend.add(srcField);
+        tgtBackend.add(tgtField);
+      }
+    }
+
+    // Apply sparse operator
+    if (tgtSparse.size() > 0) {
+      executeSparse(srcSparse, tgtSparse);
+    }
+
+    // Apply backend
+    if (tgtBackend.size() > 0) {
+      executeBackend(srcBackend, tgtBackend);
+    }
+  } else {
+    // Apply backend
+    executeBackend(srcFieldSet, tgtFieldSet);
+  }
+
+  oops::Log::trace() << classname() << "::execute done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void Interpolation::executeAdjoint(atlas::FieldSet & srcFieldSet,
+                                   const atlas::FieldSet & tgtFieldSet) const {
+  oops::Log::trace() << classname() << "::executeAdjoint starting" << std::endl;
+
+  if (sparseOperator_) {
+    // Split fields between the sparse operator and the backend
+    atlas::FieldSet srcSparse;
+    atlas::FieldSet tgtSparse;
+    atlas::FieldSet srcBackend;
+    atlas::FieldSet tgtBackend;
+    for (const auto & tgtField : tgtFieldSet) {
+      const atlas::Field srcField = srcFieldSet[tgtField.name()];
+      if (srcField.metadata().getString("interp_type", "default") == "default") {
+        srcSparse.add(srcField);
+        tgtSparse.add(tgtField);
+      } else {
+        srcBackend.add(srcField);
+        tgtBackend.add(tgtField);
+      }
+    }
+
+    // Apply sparse operator, adjoint
+    if (tgtSparse.size() > 0) {
+      executeSparseAdjoint(srcSparse, tgtSparse);
+    }
+
+    // Apply backend, adjoint
+    if (tgtBackend.size() > 0) {
+      executeBackendAdjoint(srcBackend, tgtBackend);
+    }
+  } else {
+    // Apply backend, adjoint
+    executeBackendAdjoint(srcFieldSet, tgtFieldSet);
+  }
+
+  oops::Log::trace() << classname() << "::executeAdjoint done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void Interpolation::executeBackend(atlas::FieldSet & srcFieldSet,
+                                   atlas::FieldSet & tgtFieldSet) const {
+  oops::Log::trace() << classname() << "::executeBackend starting" << std::endl;
+
+  if (parent_) {
+    // Apply parent interpolation
+    atlas::FieldSet parentFieldSet;
+    for (const auto & tgtField : tgtFieldSet) {
+      atlas::Field parentField = parent_->tgtFspace_.createField<double>(
+        atlas::option::name(tgtField.name()) | atlas::option::levels(tgtField.shape(1)));
+      parentFieldSet.add(parentField);
+    }
+    parent_->executeBackend(srcFieldSet, parentFieldSet);
+
+    // Select target points
+    for (auto & tgtField : tgtFieldSet) {
+      const auto parentView = atlas::array::make_view<double, 2>(parentFieldSet[tgtField.name()]);
+      auto tgtView = atlas::array::make_view<double, 2>(tgtField);
+      for (size_t jo = 0; jo < selection_.size(); ++jo) {
+        for (atlas::idx_t jlevel = 0; jlevel < tgtView.shape(1); ++jlevel) {
+          tgtView(jo, jlevel) = parentView(selection_[jo], jlevel);
+        }
+      }
+    }
+
+    oops::Log::trace() << classname() << "::executeBackend done" << std::endl;
+    return;
+  }
+
   if (atlasInterpWrapper_) {
     atlasInterpWrapper_->execute(srcFieldSet, tgtFieldSet);
   }
@@ -77,14 +333,13 @@ void Interpolation::execute(const atlas::FieldSet & srcFieldSet,
     regionalInterp_->execute(srcFieldSet, tgtFieldSet);
   }
   if (unstructuredInterp_) {
-    // Exchange FieldSet halo
-    atlas::FieldSet fset = util::copyFieldSet(srcFieldSet);
-    fset.haloExchange();
+    // Exchange FieldSet halo in place (only dirty fields are exchanged)
+    srcFieldSet.haloExchange();
 
     // Apply unstructured interpolator
-    const varns::Variables vars(fset.field_names());
+    const varns::Variables vars(srcFieldSet.field_names());
     std::vector<double> vals;
-    unstructuredInterp_->apply(vars, fset, vals);
+    unstructuredInterp_->apply(vars, srcFieldSet, vals);
 
     // Format data
     const auto tgtGhostView = atlas::array::make_view<int, 1>(tgtFspace_.ghost());
@@ -103,15 +358,38 @@ void Interpolation::execute(const atlas::FieldSet & srcFieldSet,
     tgtFieldSet.haloExchange();
   }
 
-
-  oops::Log::trace() << classname() << "::execute done" << std::endl;
+  oops::Log::trace() << classname() << "::executeBackend done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
 
-void Interpolation::executeAdjoint(atlas::FieldSet & srcFieldSet,
-                                   const atlas::FieldSet & tgtFieldSet) const {
-  oops::Log::trace() << classname() << "::executeAdjoint starting" << std::endl;
+void Interpolation::executeBackendAdjoint(atlas::FieldSet & srcFieldSet,
+                                          const atlas::FieldSet & tgtFieldSet) const {
+  oops::Log::trace() << classname() << "::executeBackendAdjoint starting" << std::endl;
+
+  if (parent_) {
+    // Select target points, adjoint
+    atlas::FieldSet parentFieldSet;
+    for (const auto & tgtField : tgtFieldSet) {
+      atlas::Field parentField = parent_->tgtFspace_.createField<double>(
+        atlas::option::name(tgtField.name()) | atlas::option::levels(tgtField.shape(1)));
+      auto parentView = atlas::array::make_view<double, 2>(parentField);
+      const auto tgtView = atlas::array::make_view<double, 2>(tgtField);
+      parentView.assign(0.0);
+      for (size_t jo = 0; jo < selection_.size(); ++jo) {
+        for (atlas::idx_t jlevel = 0; jlevel < tgtView.shape(1); ++jlevel) {
+          parentView(selection_[jo], jlevel) += tgtView(jo, jlevel);
+        }
+      }
+      parentFieldSet.add(parentField);
+    }
+
+    // Apply parent interpolation, adjoint
+    parent_->executeBackendAdjoint(srcFieldSet, parentFieldSet);
+
+    oops::Log::trace() << classname() << "::executeBackendAdjoint done" << std::endl;
+    return;
+  }
 
   if (atlasInterpWrapper_) {
     atlasInterpWrapper_->executeAdjoint(srcFieldSet, tgtFieldSet);
@@ -143,28 +421,248 @@ void Interpolation::executeAdjoint(atlas::FieldSet & srcFieldSet,
     srcFieldSet.set_dirty();
   }
 
-  oops::Log::trace() << classname() << "::executeAdjoint done" << std::endl;
+  oops::Log::trace() << classname() << "::executeBackendAdjoint done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void Interpolation::setupSparseOperator(const Geometry & geom) {
+  oops::Log::trace() << classname() << "::setupSparseOperator starting" << std::endl;
+
+  // Sizes
+  const size_t nSrc = geom.functionSpace().size();
+  const size_t nTgt = tgtFspace_.size();
+
+  // Owned target points (ghost target points are filled by a halo exchange)
+  const auto tgtGhostView = atlas::array::make_view<int, 1>(tgtFspace_.ghost());
+  std::vector<size_t> tgtOwned;
+  for (size_t jnode = 0; jnode < nTgt; ++jnode) {
+    if (tgtGhostView(jnode) == 0) {
+      tgtOwned.push_back(jnode);
+    }
+  }
+  tgtGhost_ = (tgtOwned.size() < nTgt);
+
+  // Weights of each target point, copied from the ATLAS matrix (regional interpolation only)
+  ASSERT(regionalInterp_);
+  std::vector<std::vector<std::pair<size_t, double>>> rows(nTgt);
+  const atlas::interpolation::MatrixCache cache(*regionalInterp_);
+  const eckit::linalg::SparseMatrix & matrix = cache.matrix();
+  ASSERT(matrix.rows() == nTgt);
+  ASSERT(matrix.cols() == nSrc);
+  const auto * outer = matrix.outer();
+  const auto * inner = matrix.inner();
+  const auto * data = matrix.data();
+  for (const auto & jnode : tgtOwned) {
+    for (auto jj = outer[jnode]; jj < outer[jnode+1]; ++jj) {
+      rows[jnode].push_back({static_cast<size_t>(inner[jj]), data[jj]});
+    }
+  }
+
+  // Build CSR matrix
+  horOperator_.rowPtr.resize(nTgt+1);
+  horOperator_.rowPtr[0] = 0;
+  for (size_t jnode = 0; jnode < nTgt; ++jnode) {
+    horOperator_.rowPtr[jnode+1] = horOperator_.rowPtr[jnode]+rows[jnode].size();
+  }
+  const size_t nnz = horOperator_.rowPtr.back();
+  horOperator_.colIndex.resize(nnz);
+  horOperator_.values.resize(nnz);
+  for (size_t jnode = 0; jnode < nTgt; ++jnode) {
+    size_t jj = horOperator_.rowPtr[jnode];
+    for (const auto & item : rows[jnode]) {
+      horOperator_.colIndex[jj] = item.first;
+      horOperator_.values[jj] = item.second;
+      ++jj;
+    }
+  }
+
+  // Build transposed CSR matrix
+  setupSparseTranspose(nSrc);
+  sparseOperator_ = true;
+
+  // Horizontal interpolation footprint: backend and sparse operator
+  horizontalBytes_ += (horOperator_.rowPtr.size()+horOperatorT_.rowPtr.size())*sizeof(size_t)
+    +2*nnz*(sizeof(size_t)+sizeof(double));
+
+  oops::Log::info() << "Info     : sparse horizontal operator " << srcUid_ << " => " << tgtUid_
+    << ": " << nnz << " non-zero weights" << std::endl;
+
+  oops::Log::trace() << classname() << "::setupSparseOperator done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void Interpolation::setupSparseTranspose(const size_t & nSrc) {
+  oops::Log::trace() << classname() << "::setupSparseTranspose starting" << std::endl;
+
+  // Transposed CSR matrix, so that the adjoint can be parallelized over source points without
+  // write conflicts
+  const size_t nTgt = horOperator_.rowPtr.size()-1;
+  const size_t nnz = horOperator_.rowPtr.back();
+  horOperatorT_.rowPtr.assign(nSrc+1, 0);
+  for (size_t jj = 0; jj < nnz; ++jj) {
+    ++horOperatorT_.rowPtr[horOperator_.colIndex[jj]+1];
+  }
+  for (size_t jnode = 0; jnode < nSrc; ++jnode) {
+    horOperatorT_.rowPtr[jnode+1] += horOperatorT_.rowPtr[jnode];
+  }
+  horOperatorT_.colIndex.resize(nnz);
+  horOperatorT_.values.resize(nnz);
+  std::vector<size_t> next(horOperatorT_.rowPtr.begin(), horOperatorT_.rowPtr.end()-1);
+  for (size_t jnode = 0; jnode < nTgt; ++jnode) {
+    for (size_t jj = horOperator_.rowPtr[jnode]; jj < horOperator_.rowPtr[jnode+1]; ++jj) {
+      const size_t jt = next[horOperator_.colIndex[jj]]++;
+      horOperatorT_.colIndex[jt] = jnode;
+      horOperatorT_.values[jt] = horOperator_.values[jj];
+    }
+  }
+
+  oops::Log::trace() << classname() << "::setupSparseTranspose done" << std::endl;
 }
 
 // -----------------------------------------------------------------------------
 
+void Interpolation::executeSparse(atlas::FieldSet & srcFieldSet,
+                                  atlas::FieldSet & tgtFieldSet) const {
+  oops::Log::trace() << classname() << "::executeSparse starting" << std::endl;
+
+  // Exchange FieldSet halo in place (only dirty fields are exchanged)
+  srcFieldSet.haloExchange();
+
+  // Views of all fields
+  std::vector<atlas::array::ArrayView<const double, 2>> srcViews;
+  std::vector<atlas::array::ArrayView<double, 2>> tgtViews;
+  for (auto & tgtField : tgtFieldSet) {
+    srcViews.push_back(atlas::array::make_view<const double, 2>(srcFieldSet[tgtField.name()]));
+    tgtViews.push_back(atlas::array::make_view<double, 2>(tgtField));
+  }
+
+  // Sparse matrix-vector product for all fields and levels in a single sweep over target points
+  const size_t nTgt = horOperator_.rowPtr.size()-1;
+  #pragma omp parallel for schedule(static)
+  for (size_t jnode = 0; jnode < nTgt; ++jnode) {
+    for (size_t jvar = 0; jvar < tgtViews.size(); ++jvar) {
+      const atlas::idx_t nlevs = tgtViews[jvar].shape(1);
+      for (atlas::idx_t jlevel = 0; jlevel < nlevs; ++jlevel) {
+        tgtViews[jvar](jnode, jlevel) = 0.0;
+      }
+      for (size_t jj = horOperator_.rowPtr[jnode]; jj < horOperator_.rowPtr[jnode+1]; ++jj) {
+        const size_t jsrc = horOperator_.colIndex[jj];
+        const double ww = horOperator_.values[jj];
+        for (atlas::idx_t jlevel = 0; jlevel < nlevs; ++jlevel) {
+          tgtViews[jvar](jnode, jlevel) += ww*srcViews[jvar](jsrc, jlevel);
+        }
+      }
+    }
+  }
+
+  // Fill target ghost points (only dirty fields are exchanged)
+  if (tgtGhost_) {
+    tgtFieldSet.set_dirty();
+    tgtFieldSet.haloExchange();
+  }
+
+  oops::Log::trace() << classname() << "::executeSparse done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void Interpolation::executeSparseAdjoint(atlas::FieldSet & srcFieldSet,
+                                         const atlas::FieldSet & tgtFieldSet) const {
+  oops::Log::trace() << classname() << "::executeSparseAdjoint starting" << std::endl;
+
+  // Adjoint of the target ghost points fill, on a copy of the target fields
+  atlas::FieldSet tgtAdjoint;
+  if (tgtGhost_) {
+    tgtAdjoint = util::copyFieldSet(tgtFieldSet);
+    tgtAdjoint.adjointHaloExchange();
+  } else {
+    tgtAdjoint = tgtFieldSet;
+  }
+
+  // Views of all fields
+  std::vector<atlas::array::ArrayView<double, 2>> srcViews;
+  std::vector<atlas::array::ArrayView<const double, 2>> tgtViews;
+  for (const auto & tgtField : tgtAdjoint) {
+    srcViews.push_back(atlas::array::make_view<double, 2>(srcFieldSet[tgtField.name()]));
+    tgtViews.push_back(atlas::array::make_view<const double, 2>(tgtField));
+  }
+
+  // Transposed sparse matrix-vector product, each source point being updated by a single thread
+  const size_t nSrc = horOperatorT_.rowPtr.size()-1;
+  #pragma omp parallel for schedule(static)
+  for (size_t jnode = 0; jnode < nSrc; ++jnode) {
+    for (size_t jvar = 0; jvar < srcViews.size(); ++jvar) {
+      const atlas::idx_t nlevs = srcViews[jvar].shape(1);
+      for (size_t jj = horOperatorT_.rowPtr[jnode]; jj < horOperatorT_.rowPtr[jnode+1]; ++jj) {
+        const size_t jtgt = horOperatorT_.colIndex[jj];
+        const double ww = horOperatorT_.values[jj];
+        for (atlas::idx_t jlevel = 0; jlevel < nlevs; ++jlevel) {
+          srcViews[jvar](jnode, jlevel) += ww*tgtViews[jvar](jtgt, jlevel);
+        }
+      }
+    }
+  }
+
+  // Exchange FieldSet halo, adjoint
+  srcFieldSet.adjointHaloExchange();
+  srcFieldSet.set_dirty();
 
-void Interpolation::insertVerticalInterpolation(const std::string & var,
+  oops::Log::trace() << classname() << "::executeSparseAdjoint done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+
+void Interpolation::insertVerticalInterpolation(const std::vector<std::string> & vars,
                                                 const std::vector<std::array<size_t, 2>> & stencil,
                                                 const std::vector<std::array<double, 2>> & weights,
                                                 const std::vector<size_t> & stencilSize) {
   oops::Log::trace() << classname() << "::insertVerticalInterpolation starting" << std::endl;
 
-  if (verStencil_.find(var) != verStencil_.end()) {
-    throw eckit::Exception("vertical interpolation already computed for this variables");
+  for (const auto & var : vars) {
+    if (verOperatorIndex_.find(var) != verOperatorIndex_.end()) {
+      throw eckit::Exception("vertical interpolation already computed for this variables");
+    }
   }
   ASSERT(stencil.size() == stencilSize.size());
   ASSERT(weights.size() == stencilSize.size());
-  verStencil_.insert({var, stencil});
-  verWeights_.insert({var, weights});
-  verStencilSize_.insert({var, stencilSize});
 
-  oops::Log::trace() << classname() << "::insertVerticalInterpolation starting" << std::endl;
+  // Build CSR matrix
+  CsrMatrix op;
+  op.rowPtr.resize(stencilSize.size()+1);
+  op.rowPtr[0] = 0;
+  for (size_t jo = 0; jo < stencilSize.size(); ++jo) {
+    op.rowPtr[jo+1] = op.rowPtr[jo]+stencilSize[jo];
+  }
+  op.colIndex.resize(op.rowPtr.back());
+  op.values.resize(op.rowPtr.back());
+  for (size_t jo = 0; jo < stencilSize.size(); ++jo) {
+    for (size_t jj = 0; jj < stencilSize[jo]; ++jj) {
+      op.colIndex[op.rowPtr[jo]+jj] = stencil[jo][jj];
+      op.values[op.rowPtr[jo]+jj] = weights[jo][jj];
+    }
+  }
+
+  // Share it among the group variables
+  for (const auto & var : vars) {
+    verOperatorIndex_.insert({var, verOperators_.size()});
+  }
+  verOperators_.push_back(std::move(op));
+
+  oops::Log::trace() << classname() << "::insertVerticalInterpolation done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+std::vector<std::vector<std::string>> Interpolation::verticalBatches(
+  const atlas::FieldSet & fset) const {
+  std::vector<std::vector<std::string>> batches(verOperators_.size());
+  for (const auto & field : fset) {
+    batches[verOperatorIndex_.at(field.name())].push_back(field.name());
+  }
+  return batches;
 }
 
 // -----------------------------------------------------------------------------
@@ -173,14 +671,31 @@ void Interpolation::executeVertical(const atlas::FieldSet & srcFieldSet,
                                     atlas::FieldSet & tgtFieldSet) const {
   oops::Log::trace() << classname() << "::executeVertical starting" << std::endl;
 
-  for (auto & tgtField : tgtFieldSet) {
-    const std::string var = tgtField.name();
-    const auto srcView = atlas::array::make_view<double, 2>(srcFieldSet[var]);
-    auto tgtView = atlas::array::make_view<double, 2>(tgtField);
-    tgtView.assign(0.0);
-    for (size_t jo = 0; jo < verStencilSize_.at(var).size(); ++jo) {
-      for (size_t jj = 0; jj < verStencilSize_.at(var)[jo]; ++jj) {
-        tgtView(jo, 0) += verWeights_.at(var)[jo][jj]*srcView(jo, verStencil_.at(var)[jo][jj]);
+  const std::vector<std::vector<std::string>> batches = verticalBatches(tgtFieldSet);
+  for (size_t jop = 0; jop < batches.size(); ++jop) {
+    if (batches[jop].empty()) {
+      continue;
+    }
+    const CsrMatrix & op = verOperators_[jop];
+
+    // Views of the batch fields
+    std::vector<atlas::array::ArrayView<const double, 2>> srcViews;
+    std::vector<atlas::array::ArrayView<double, 2>> tgtViews;
+    for (const auto & var : batches[jop]) {
+      srcViews.push_back(atlas::array::make_view<const double, 2>(srcFieldSet[var]));
+      tgtViews.push_back(atlas::array::make_view<double, 2>(tgtFieldSet[var]));
+    }
+
+    // Sparse matrix-vector product for all fields of the batch
+    const size_t nobs = op.rowPtr.size()-1;
+    #pragma omp parallel for schedule(static)
+    for (size_t jo = 0; jo < nobs; ++jo) {
+      for (size_t jvar = 0; jvar < tgtViews.size(); ++jvar) {
+        double zz = 0.0;
+        for (size_t jj = op.rowPtr[jo]; jj < op.rowPtr[jo+1]; ++jj) {
+          zz += op.values[jj]*srcViews[jvar](jo, op.colIndex[jj]);
+        }
+        tgtViews[jvar](jo, 0) = zz;
       }
     }
   }
@@ -194,14 +709,33 @@ void Interpolation::executeVerticalAdjoint(atlas::FieldSet & srcFieldSet,
                                            const atlas::FieldSet & tgtFieldSet) const {
   oops::Log::trace() << classname() << "::executeVerticalAdjoint starting" << std::endl;
 
-  for (const auto & tgtField : tgtFieldSet) {
-    const std::string var = tgtField.name();
-    auto srcView = atlas::array::make_view<double, 2>(srcFieldSet[var]);
-    const auto tgtView = atlas::array::make_view<double, 2>(tgtField);
-    srcView.assign(0.0);
-    for (size_t jo = 0; jo < verStencilSize_.at(var).size(); ++jo) {
-      for (size_t jj = 0; jj < verStencilSize_.at(var)[jo]; ++jj) {
-        srcView(jo, verStencil_.at(var)[jo][jj]) += verWeights_.at(var)[jo][jj]*tgtView(jo, 0);
+  const std::vector<std::vector<std::string>> batches = verticalBatches(tgtFieldSet);
+  for (size_t jop = 0; jop < batches.size(); ++jop) {
+    if (batches[jop].empty()) {
+      continue;
+    }
+    const CsrMatrix & op = verOperators_[jop];
+
+    // Views of the batch fields
+    std::vector<atlas::array::ArrayView<double, 2>> srcViews;
+    std::vector<atlas::array::ArrayView<const double, 2>> tgtViews;
+    for (const auto & var : batches[jop]) {
+      srcViews.push_back(atlas::array::make_view<double, 2>(srcFieldSet[var]));
+      tgtViews.push_back(atlas::array::make_view<const double, 2>(tgtFieldSet[var]));
+    }
+
+    // Transpose sparse matrix-vector product for all fields of the batch (each observation only
+    // updates its own column, so that rows can be processed in parallel)
+    const size_t nobs = op.rowPtr.size()-1;
+    #pragma omp parallel for schedule(static)
+    for (size_t jo = 0; jo < nobs; ++jo) {
+      for (size_t jvar = 0; jvar < srcViews.size(); ++jvar) {
+        for (atlas::idx_t jlevel = 0; jlevel < srcViews[jvar].shape(1); ++jlevel) {
+          srcViews[jvar](jo, jlevel) = 0.0;
+        }
+        for (size_t jj = op.rowPtr[jo]; jj < op.rowPtr[jo+1]; ++jj) {
+          srcViews[jvar](jo, op.colIndex[jj]) += op.values[jj]*tgtViews[jvar](jo, 0);
+        }
       }
     }
   }
@@ -211,4 +745,57 @@ void Interpolation::executeVerticalAdjoint(atlas::FieldSet & srcFieldSet,
 
 // -----------------------------------------------------------------------------
 
+void Interpolation::setObservationKeys(const std::vector<uint64_t> & keys) {
+  oops::Log::trace() << classname() << "::setObservationKeys starting" << std::endl;
+
+  ASSERT(keys.size() == static_cast<size_t>(tgtFspace_.size()));
+  obsKeys_.clear();
+  obsKeys_.reserve(keys.size());
+  for (size_t jo = 0; jo < keys.size(); ++jo) {
+    obsKeys_.insert({keys[jo], jo});
+  }
+  obsKeysSet_ = true;
+
+  oops::Log::trace() << classname() << "::setObservationKeys done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+bool Interpolation::selectObservations(const std::vector<uint64_t> & keys,
+                                       std::vector<size_t> & selection) const {
+  oops::Log::trace() << classname() << "::selectObservations starting" << std::endl;
+
+  if (!obsKeysSet_) {
+    oops::Log::trace() << classname() << "::selectObservations done" << std::endl;
+    return false;
+  }
+
+  // Local target index of each observation
+  selection.resize(keys.size());
+  for (size_t jo = 0; jo < keys.size(); ++jo) {
+    const auto it = obsKeys_.find(keys[jo]);
+    if (it == obsKeys_.end()) {
+      oops::Log::trace() << classname() << "::selectObservations done" << std::endl;
+      return false;
+    }
+    selection[jo] = it->second;
+  }
+
+  oops::Log::trace() << classname() << "::selectObservations done" << std::endl;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t Interpolation::bytes() const {
+  size_t nn = horizontalBytes_+obsKeys_.size()*(sizeof(uint64_t)+sizeof(size_t));
+  for (const auto & op : verOperators_) {
+    nn += op.rowPtr.size()*sizeof(size_t)+op.colIndex.size()*sizeof(size_t)
+      +op.values.size()*sizeof(double);
+  }
+  return nn;
+}
+
+// -----------------------------------------------------------------------------
+
 }  // namespace quenchxx
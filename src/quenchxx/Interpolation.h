@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <iomanip>
 #include <memory>
 #include <string>
@@ -48,17 +49,23 @@ class Interpolation {
                 const std::string &,
                 const atlas::Grid &,
                 const atlas::FunctionSpace &,
+                const std::string &,
+                const bool cacheWeights = false);
+  Interpolation(const std::shared_ptr<const Interpolation> &,
+                const std::vector<size_t> &,
+                const atlas::FunctionSpace &,
                 const std::string &);
   ~Interpolation() {}
 
   // Horizontal interpolation and adjoint
-  void execute(const atlas::FieldSet &,
+  void execute(atlas::FieldSet &,
                atlas::FieldSet &) const;
   void executeAdjoint(atlas::FieldSet &,
                       const atlas::FieldSet &) const;
 
-  // Vertical interpolation
-  void insertVerticalInterpolation(const std::string &,
+  // Vertical interpolation, shared by a group of variables (fields of the same group are applied
+  // in a single pass over the observations)
+  void insertVerticalInterpolation(const std::vector<std::string> &,
                                    const std::vector<std::array<size_t, 2>> &,
                                    const std::vector<std::array<double, 2>> &,
                                    const std::vector<size_t> &);
@@ -66,6 +73,14 @@ class Interpolation {
                        atlas::FieldSet &) const;
   void executeVerticalAdjoint(atlas::FieldSet &,
                               const atlas::FieldSet &) const;
+  bool hasVerticalInterpolation(const std::string & var) const
+    {return verOperatorIndex_.find(var) != verOperatorIndex_.end();}
+
+  // Observation keys, to reuse the stencils for another set of observations (selection fails
+  // unless every key is found)
+  void setObservationKeys(const std::vector<uint64_t> &);
+  bool selectObservations(const std::vector<uint64_t> &,
+                          std::vector<size_t> &) const;
 
   // Accessors
   const std::string & srcUid() const
@@ -74,6 +89,15 @@ class Interpolation {
     {return tgtUid_;}
   const atlas::FunctionSpace & tgtFspace() const
     {return tgtFspace_;}
+  bool weightsFromCache() const
+    {return weightsFromCache_;}
+  bool sparseOperator() const
+    {return sparseOperator_;}
+  const std::shared_ptr<const Interpolation> & parent() const
+    {return parent_;}
+
+  // Approximate memory footprint in bytes
+  size_t bytes() const;
 
  private:
   // Grids UID
@@ -83,6 +107,12 @@ class Interpolation {
   // Destination function space
   atlas::FunctionSpace tgtFspace_;
 
+  // Approximate memory footprint of the horizontal interpolation
+  size_t horizontalBytes_;
+
+  // Weights read from the cache directory
+  bool weightsFromCache_;
+
   // ATLAS interpolation wrapper from SABER
   std::shared_ptr<saber::interpolation::AtlasInterpWrapper> atlasInterpWrapper_;
 
@@ -92,10 +122,49 @@ class Interpolation {
   // OOPS unstructured interpolation
   std::shared_ptr<oops::UnstructuredInterpolator> unstructuredInterp_;
 
-  // Vertical interpolations
-  std::unordered_map<std::string, std::vector<std::array<size_t, 2>>> verStencil_;
-  std::unordered_map<std::string, std::vector<std::array<double, 2>>> verWeights_;
-  std::unordered_map<std::string, std::vector<size_t>> verStencilSize_;
+  // Sparse matrix in CSR format
+  struct CsrMatrix {
+    std::vector<size_t> rowPtr;
+    std::vector<size_t> colIndex;
+    std::vector<double> values;
+  };
+
+  // Horizontal interpolation applied by the backend
+  void executeBackend(atlas::FieldSet &,
+                      atlas::FieldSet &) const;
+  void executeBackendAdjoint(atlas::FieldSet &,
+                             const atlas::FieldSet &) const;
+
+  // Horizontal interpolation applied with the sparse operator (regional interpolation only)
+  void setupSparseOperator(const Geometry &);
+  void executeSparse(atlas::FieldSet &,
+                     atlas::FieldSet &) const;
+  void executeSparseAdjoint(atlas::FieldSet &,
+                            const atlas::FieldSet &) const;
+  void setupSparseTranspose(const size_t &);
+
+  // Sparse horizontal operator (one row per target point, one column per source point including
+  // halo) and its transpose, used for "default" interpolation type fields
+  bool sparseOperator_;
+  bool tgtGhost_;
+  CsrMatrix horOperator_;
+  CsrMatrix horOperatorT_;
+
+  // Fields of a fieldset grouped by vertical operator
+  std::vector<std::vector<std::string>> verticalBatches(const atlas::FieldSet &) const;
+
+  // Vertical interpolations (one CSR matrix per group of variables, with one row per observation
+  // and levels as columns)
+  std::vector<CsrMatrix> verOperators_;
+  std::unordered_map<std::string, size_t> verOperatorIndex_;
+
+  // Local target index of each observation key
+  bool obsKeysSet_;
+  std::unordered_map<uint64_t, size_t> obsKeys_;
+
+  // Interpolation applied to a selection of the target points of a parent interpolation
+  std::shared_ptr<const Interpolation> parent_;
+  std::vector<size_t> selection_;
 };
 
 }  // namespace quenchxx
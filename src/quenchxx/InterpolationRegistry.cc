@@ -0,0 +1,265 @@
+/*
+ * (C) Copyright 2025 Meteorologisk Institutt
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "quenchxx/InterpolationRegistry.h"
+
+#include <algorithm>
+
+#include "eckit/config/Resource.h"
+#include "eckit/thread/AutoLock.h"
+
+#include "oops/util/Logger.h"
+
+namespace quenchxx {
+
+// -----------------------------------------------------------------------------
+
+static std::string registryKey(const std::string & srcUid,
+                               const std::string & tgtUid) {
+  return srcUid + "|" + tgtUid;
+}
+
+// -----------------------------------------------------------------------------
+
+InterpolationRegistry & InterpolationRegistry::instance() {
+  static InterpolationRegistry registry;
+  return registry;
+}
+
+// -----------------------------------------------------------------------------
+
+InterpolationRegistry::InterpolationRegistry()
+  : entries_(), lru_(), retained_(), maxBytes_(0), bytes_(0), hits_(0), misses_(0),
+  evictions_(0) {
+  // Process-wide memory budget
+  maxBytes_ = eckit::Resource<size_t>(
+    "quenchxxInterpolationRegistryMaxBytes;$QUENCHXX_INTERPOLATION_REGISTRY_MAX_BYTES", 0);
+}
+
+// -----------------------------------------------------------------------------
+
+std::shared_ptr<Interpolation> InterpolationRegistry::find(const std::string & srcUid,
+                                                           const std::string & tgtUid) {
+  oops::Log::trace() << classname() << "::find starting" << std::endl;
+
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  std::shared_ptr<Interpolation> interpolation;
+  auto it = entries_.find(registryKey(srcUid, tgtUid));
+  if (it != entries_.end()) {
+    // Move to the front of the LRU list
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    interpolation = it->second.interpolation;
+    ++hits_;
+  } else {
+    ++misses_;
+  }
+
+  oops::Log::trace() << classname() << "::find done" << std::endl;
+  return interpolation;
+}
+
+// -----------------------------------------------------------------------------
+
+std::vector<std::shared_ptr<Interpolation>> InterpolationRegistry::candidates(
+  const std::string & srcUid) const {
+  oops::Log::trace() << classname() << "::candidates starting" << std::endl;
+
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  std::vector<std::shared_ptr<Interpolation>> interpolations;
+  for (const auto & entry : entries_) {
+    if (entry.second.interpolation->srcUid() == srcUid) {
+      interpolations.push_back(entry.second.interpolation);
+    }
+  }
+  std::sort(interpolations.begin(), interpolations.end(),
+    [](const std::shared_ptr<Interpolation> & lhs, const std::shared_ptr<Interpolation> & rhs)
+    {return lhs->tgtUid() < rhs->tgtUid();});
+
+  oops::Log::trace() << classname() << "::candidates done" << std::endl;
+  return interpolations;
+}
+
+// -----------------------------------------------------------------------------
+
+std::shared_ptr<Interpolation> InterpolationRegistry::insert(
+  const std::shared_ptr<Interpolation> & interpolation,
+  const eckit::mpi::Comm & comm) {
+  oops::Log::trace() << classname() << "::insert starting" << std::endl;
+
+  // Footprint identical on all tasks
+  size_t bytes = interpolation->bytes();
+  comm.allReduceInPlace(bytes, eckit::mpi::max());
+
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  const std::string key = registryKey(interpolation->srcUid(), interpolation->tgtUid());
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    // Already inserted concurrently
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    oops::Log::trace() << classname() << "::insert done" << std::endl;
+    return it->second.interpolation;
+  }
+
+  // Insert new entry
+  lru_.push_front(key);
+  Entry entry;
+  entry.interpolation = interpolation;
+  entry.bytes = bytes;
+  entry.lru = lru_.begin();
+  entries_.insert({key, entry});
+  bytes_ += entry.bytes;
+
+  // Enforce budget
+  evict();
+  oops::Log::debug() << *this;
+
+  oops::Log::trace() << classname() << "::insert done" << std::endl;
+  return interpolation;
+}
+
+// -----------------------------------------------------------------------------
+
+void InterpolationRegistry::setMaxBytes(const size_t & maxBytes) {
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  maxBytes_ = maxBytes;
+  evict();
+}
+
+// -----------------------------------------------------------------------------
+
+void InterpolationRegistry::clear() {
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  entries_.clear();
+  lru_.clear();
+  retained_.clear();
+  bytes_ = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t InterpolationRegistry::size() const {
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  return entries_.size();
+}
+
+// -----------------------------------------------------------------------------
+
+size_t InterpolationRegistry::bytes() const {
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  return bytes_+retainedBytes();
+}
+
+// -----------------------------------------------------------------------------
+
+size_t InterpolationRegistry::hits() const {
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  return hits_;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t InterpolationRegistry::misses() const {
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  return misses_;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t InterpolationRegistry::evictions() const {
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  return evictions_;
+}
+
+// -----------------------------------------------------------------------------
+
+double InterpolationRegistry::hitRate() const {
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  return hits_+misses_ > 0 ? static_cast<double>(hits_)/static_cast<double>(hits_+misses_)
+    : 0.0;
+}
+
+// -----------------------------------------------------------------------------
+
+void InterpolationRegistry::evict() {
+  // Forget evicted parents released by all their children
+  retained_.erase(std::remove_if(retained_.begin(), retained_.end(),
+    [](const Retained & retained) {return retained.interpolation.expired();}), retained_.end());
+
+  // Keep at least the most recently used interpolation (interpolations in use remain alive
+  // through their shared pointers anyway)
+  while (maxBytes_ > 0 && bytes_+retainedBytes() > maxBytes_ && lru_.size() > 1) {
+    const std::string key = lru_.back();
+    lru_.pop_back();
+    auto it = entries_.find(key);
+    std::weak_ptr<const Interpolation> evicted = it->second.interpolation;
+    const size_t evictedBytes = it->second.bytes;
+    bytes_ -= evictedBytes;
+    entries_.erase(it);
+    ++evictions_;
+
+    // A parent used by registered children stays alive, keep counting it
+    const std::shared_ptr<const Interpolation> parent = evicted.lock();
+    if (parent) {
+      for (const auto & entry : entries_) {
+        if (entry.second.interpolation->parent() == parent) {
+          retained_.push_back({evicted, evictedBytes});
+          break;
+        }
+      }
+    }
+
+    // Forget evicted parents released by this eviction
+    retained_.erase(std::remove_if(retained_.begin(), retained_.end(),
+      [](const Retained & retained) {return retained.interpolation.expired();}), retained_.end());
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+size_t InterpolationRegistry::retainedBytes() const {
+  size_t nn = 0;
+  for (const auto & retained : retained_) {
+    if (!retained.interpolation.expired()) {
+      nn += retained.bytes;
+    }
+  }
+  return nn;
+}
+
+// -----------------------------------------------------------------------------
+
+void InterpolationRegistry::print(std::ostream & os) const {
+  oops::Log::trace() << classname() << "::print starting" << std::endl;
+
+  eckit::AutoLock<eckit::Mutex> lock(mutex_);
+  std::string prefix;
+  if (os.rdbuf() == oops::Log::info().rdbuf()) {
+    prefix = "Info     : ";
+  }
+  const double hitRate = hits_+misses_ > 0
+    ? static_cast<double>(hits_)/static_cast<double>(hits_+misses_) : 0.0;
+  os << prefix << "Interpolation registry statistics:" << std::endl;
+  os << prefix << "- entries: " << entries_.size() << std::endl;
+  os << prefix << "- size: " << bytes_+retainedBytes() << " bytes";
+  if (maxBytes_ > 0) {
+    os << " (budget: " << maxBytes_ << " bytes)";
+  }
+  os << std::endl;
+  os << prefix << "- hits: " << hits_ << std::endl;
+  os << prefix << "- misses: " << misses_ << std::endl;
+  os << prefix << "- hit rate: " << 100.0*hitRate << " %" << std::endl;
+  os << prefix << "- evictions: " << evictions_ << std::endl;
+  os << prefix << "- evicted parents still in use: "
+     << std::count_if(retained_.begin(), retained_.end(),
+        [](const Retained & retained) {return !retained.interpolation.expired();}) << std::endl;
+
+  oops::Log::trace() << classname() << "::print done" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+}  // namespace quenchxx
@@ -0,0 +1,115 @@
+/*
+ * (C) Copyright 2025 Meteorologisk Institutt
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "eckit/mpi/Comm.h"
+#include "eckit/thread/Mutex.h"
+
+#include "oops/util/Printable.h"
+
+#include "quenchxx/Interpolation.h"
+
+namespace quenchxx {
+
+// -----------------------------------------------------------------------------
+/// Registry of interpolations, hashed by source and target UIDs, thread-safe, with an optional
+/// memory budget enforced by evicting the least recently used interpolations. The budget is a
+/// process-wide setting, read once from the "quenchxxInterpolationRegistryMaxBytes" resource
+/// (environment variable QUENCHXX_INTERPOLATION_REGISTRY_MAX_BYTES).
+
+class InterpolationRegistry : public util::Printable {
+ public:
+  static const std::string classname()
+    {return "quenchxx::InterpolationRegistry";}
+
+  // Unique instance
+  static InterpolationRegistry & instance();
+
+  // Find an interpolation (nullptr if absent)
+  std::shared_ptr<Interpolation> find(const std::string &,
+                                      const std::string &);
+
+  // Interpolations from a given source, sorted by target UID so that the order does not depend
+  // on the usage history (statistics and LRU order are not updated)
+  std::vector<std::shared_ptr<Interpolation>> candidates(const std::string &) const;
+
+  // Insert an interpolation, return the registered one if it was inserted concurrently
+  // (collective: the footprint is the maximum over the communicator, so that all tasks evict the
+  // same entries and keep their lookups, hence their collective setups, consistent)
+  std::shared_ptr<Interpolation> insert(const std::shared_ptr<Interpolation> &,
+                                        const eckit::mpi::Comm &);
+
+  // Memory budget in bytes (0 for no limit), overriding the resource value
+  void setMaxBytes(const size_t &);
+
+  // Remove all interpolations
+  void clear();
+
+  // Statistics
+  size_t size() const;
+  size_t bytes() const;
+  size_t hits() const;
+  size_t misses() const;
+  size_t evictions() const;
+  double hitRate() const;
+
+ private:
+  InterpolationRegistry();
+
+  // Print
+  void print(std::ostream &) const;
+
+  // Evict least recently used interpolations until the budget is met (mutex must be locked)
+  void evict();
+
+  // Bytes of the evicted parents still alive (mutex must be locked)
+  size_t retainedBytes() const;
+
+  // Registry entry
+  struct Entry {
+    std::shared_ptr<Interpolation> interpolation;
+    size_t bytes;
+    std::list<std::string>::iterator lru;
+  };
+
+  // Entries, hashed by key
+  std::unordered_map<std::string, Entry> entries_;
+
+  // Keys from most to least recently used
+  std::list<std::string> lru_;
+
+  // Evicted parent interpolations, kept alive by their children
+  struct Retained {
+    std::weak_ptr<const Interpolation> interpolation;
+    size_t bytes;
+  };
+  std::vector<Retained> retained_;
+
+  // Memory budget
+  size_t maxBytes_;
+
+  // Mutex
+  mutable eckit::Mutex mutex_;
+
+  // Statistics
+  size_t bytes_;
+  size_t hits_;
+  size_t misses_;
+  size_t evictions_;
+};
+
+// -----------------------------------------------------------------------------
+
+}  // namespace quenchxx
@@ -46,7 +46,7 @@ ObsSpace::ObsSpace(const eckit::Configuration & config,
                    const util::DateTime & end,
                    const bool lscreened)
   : winbgn_(bgn), winend_(end), lscreened_(lscreened), comm_(geom.getComm()),
-    geom_(new Geometry(geom)), nobsOwn_(0), nobsLoc_(0), nobsGlb_(0),
+    geom_(Geometry::shared(geom)), nobsOwn_(0), nobsLoc_(0), nobsGlb_(0),
     vars_(config.getStringVector("variables")) {
   oops::Log::trace() << classname() << "::ObsSpace starting" << std::endl;
 
@@ -466,217 +466,212 @@ void ObsSpace::print(std::ostream & os) const {
 void ObsSpace::read(const std::string & filePath) {
   oops::Log::trace() << classname() << "::read starting" << std::endl;
 
-  // Global size and vectors
-  int ngrp;
-  std::vector<int> timesGlb;
-  std::vector<double> locsGlb;
-  std::vector<double> dataGlb;
-
-  // Counts and displacements
-  nobsOwnVec_.resize(comm_.size());
-
   // NetCDF IDs
-  std::string ncFilePath;
   int retval, ncid, nobsGlb_id, Location_id, dateTime_id, longitude_id, latitude_id, height_id,
     data_id;
-  std::vector<int> group_ids;
 
-  if (comm_.rank() == 0) {
-    // Open NetCDF file
-    ncFilePath = filePath + ".nc";
-    oops::Log::info() << "Info     : Reading file: " << ncFilePath << std::endl;
-    if (retval = nc_open(ncFilePath.c_str(), NC_NOWRITE, &ncid)) ERR(retval, ncFilePath);
+  // Open NetCDF file on each task (independent read-only access)
+  const std::string ncFilePath = filePath + ".nc";
+  oops::Log::info() << "Info     : Reading file: " << ncFilePath << std::endl;
+  if (retval = nc_open(ncFilePath.c_str(), NC_NOWRITE, &ncid)) ERR(retval, ncFilePath);
 
-    // Get dimension
-    if (retval = nc_inq_dimid(ncid, "Location", &nobsGlb_id)) ERR(retval, "Location");
-    if (retval = nc_inq_dimlen(ncid, nobsGlb_id, &nobsGlb_)) ERR(retval, "Location");
+  // Get dimension
+  if (retval = nc_inq_dimid(ncid, "Location", &nobsGlb_id)) ERR(retval, "Location");
+  if (retval = nc_inq_dimlen(ncid, nobsGlb_id, &nobsGlb_)) ERR(retval, "Location");
+  nobsGlbAll_ = nobsGlb_;
 
-    // Get locations order
-    order_.resize(nobsGlb_);
-    if (retval = nc_inq_varid(ncid, "Location", &Location_id)) ERR(retval, "Location");
-    if (retval = nc_get_var_int(ncid, Location_id, order_.data())) ERR(retval, "Location");
+  // Contiguous hyperslab read by each task
+  std::vector<int> slabCounts(comm_.size());
+  std::vector<int> slabDispls(comm_.size());
+  for (size_t jt = 0; jt < comm_.size(); ++jt) {
+    slabDispls[jt] = (jt*nobsGlb_)/comm_.size();
+    slabCounts[jt] = ((jt+1)*nobsGlb_)/comm_.size()-slabDispls[jt];
+  }
+  const size_t slabStart = slabDispls[comm_.rank()];
+  const size_t slabSize = slabCounts[comm_.rank()];
 
-    // Get groups list
-    if (retval = nc_inq_grps(ncid, &ngrp, NULL)) ERR(retval, "ngrp");
-    group_ids.resize(ngrp);
-    if (retval = nc_inq_grps(ncid, NULL, group_ids.data())) ERR(retval, "group_ids");
+  // Get locations order
+  std::vector<int> orderSlab(slabSize);
+  if (retval = nc_inq_varid(ncid, "Location", &Location_id)) ERR(retval, "Location");
+  if (retval = nc_get_vara_int(ncid, Location_id, &slabStart, &slabSize, orderSlab.data()))
+    ERR(retval, "Location");
 
-    // Get MetaData
-    int meta_group_id;
-    if (retval = nc_inq_grp_ncid(ncid, "MetaData", &meta_group_id)) ERR(retval, "MetaData");
+  // Get groups list
+  int ngrp;
+  if (retval = nc_inq_grps(ncid, &ngrp, NULL)) ERR(retval, "ngrp");
+  std::vector<int> group_ids(ngrp);
+  if (retval = nc_inq_grps(ncid, NULL, group_ids.data())) ERR(retval, "group_ids");
+
+  // Get MetaData
+  int meta_group_id;
+  if (retval = nc_inq_grp_ncid(ncid, "MetaData", &meta_group_id)) ERR(retval, "MetaData");
+
+  // Get dateTime from MetaData
+  std::vector<int64_t> dateTime(slabSize);
+  if (retval = nc_inq_varid(meta_group_id, "dateTime", &dateTime_id)) ERR(retval, "dateTime");
+  if (retval = nc_get_vara_long(meta_group_id, dateTime_id, &slabStart, &slabSize,
+    dateTime.data())) ERR(retval, "dateTime");
+  const std::string dateTime_units_key = "units";
+  size_t attlen;
+  if (retval = nc_inq_attlen(meta_group_id, dateTime_id, dateTime_units_key.c_str(),
+    &attlen)) ERR(retval, "dateTime");
+  char **dateTime_units_char = reinterpret_cast<char**>(malloc(attlen*sizeof(char*)));
+  memset(dateTime_units_char, 0, attlen*sizeof(char*));
+  if (retval = nc_get_att_string(meta_group_id, dateTime_id, dateTime_units_key.c_str(),
+    dateTime_units_char)) ERR(retval, "dateTime");
+  const std::string dateTime_units_value(*dateTime_units_char);
+  nc_free_string(attlen, dateTime_units_char);
+  free(dateTime_units_char);
+  const util::DateTime start(dateTime_units_value.substr(14, 20));
+
+  // Get longitude, latitude and height from MetaData
+  std::vector<float> longitude(slabSize);
+  std::vector<float> latitude(slabSize);
+  std::vector<float> height(slabSize);
+  if (retval = nc_inq_varid(meta_group_id, "longitude", &longitude_id)) ERR(retval,
+    "longitude");
+  if (retval = nc_get_vara_float(meta_group_id, longitude_id, &slabStart, &slabSize,
+    longitude.data())) ERR(retval, "longitude");
+  if (retval = nc_inq_varid(meta_group_id, "latitude", &latitude_id)) ERR(retval, "latitude");
+  if (retval = nc_get_vara_float(meta_group_id, latitude_id, &slabStart, &slabSize,
+    latitude.data())) ERR(retval, "latitude");
+  if (retval = nc_inq_varid(meta_group_id, "height", &height_id)) ERR(retval, "height");
+  if (retval = nc_get_vara_float(meta_group_id, height_id, &slabStart, &slabSize,
+    height.data())) ERR(retval, "height");
+
+  // Get non-MetaData groups
+  std::vector<std::string> dataGrpNames;
+  std::vector<int> dataGrpIds;
+  for (int jgrp = 0; jgrp < ngrp; ++jgrp) {
+    size_t grpNameLen = 0;
+    if (retval = nc_inq_grpname_len(group_ids[jgrp], &grpNameLen)) ERR(retval,
+      std::to_string(group_ids[jgrp]));
+    std::string grpName(grpNameLen, ' ');
+    if (retval = nc_inq_grpname(group_ids[jgrp], &grpName[0])) ERR(retval,
+      std::to_string(group_ids[jgrp]));
+    if (grpName.substr(0, grpNameLen-1) != "MetaData") {
+      dataGrpNames.push_back(grpName.substr(0, grpNameLen-1));
+      dataGrpIds.push_back(group_ids[jgrp]);
+    }
+  }
 
-    // Get dateTime from MetaData
-    std::vector<int64_t> dateTime(nobsGlb_);
-    if (retval = nc_inq_varid(meta_group_id, "dateTime", &dateTime_id)) ERR(retval, "dateTime");
-    if (retval = nc_get_var_long(meta_group_id, dateTime_id, dateTime.data())) ERR(retval,
-      "dateTime");
-    const std::string dateTime_units_key = "units";
-    size_t attlen;
-    if (retval = nc_inq_attlen(meta_group_id, dateTime_id, dateTime_units_key.c_str(),
-      &attlen)) ERR(retval, "dateTime");
-    char **dateTime_units_char = reinterpret_cast<char**>(malloc(attlen*sizeof(char*)));
-    memset(dateTime_units_char, 0, attlen*sizeof(char*));
-    if (retval = nc_get_att_string(meta_group_id, dateTime_id, dateTime_units_key.c_str(),
-      dateTime_units_char)) ERR(retval, "dateTime");
-    const std::string dateTime_units_value(*dateTime_units_char);
-    const util::DateTime start(dateTime_units_value.substr(14, 20));
-
-    // Get longitude, latitude and height from MetaData
-    std::vector<float> longitude(nobsGlb_);
-    std::vector<float> latitude(nobsGlb_);
-    std::vector<float> height(nobsGlb_);
-    if (retval = nc_inq_varid(meta_group_id, "longitude", &longitude_id)) ERR(retval,
-      "longitude");
-    if (retval = nc_get_var_float(meta_group_id, longitude_id, longitude.data()))
-      ERR(retval, "longitude");
-    if (retval = nc_inq_varid(meta_group_id, "latitude", &latitude_id)) ERR(retval, "latitude");
-    if (retval = nc_get_var_float(meta_group_id, latitude_id, latitude.data())) ERR(retval,
-     "latitude");
-    if (retval = nc_inq_varid(meta_group_id, "height", &height_id)) ERR(retval, "height");
-    if (retval = nc_get_var_float(meta_group_id, height_id, height.data())) ERR(retval, "height");
-
-    // Set mask
-    nobsGlbAll_ = nobsGlb_;
-    mask_.resize(nobsGlb_);
-    maskSum_.resize(nobsGlb_);
-    std::fill(mask_.begin(), mask_.end(), 1);
-    std::fill(maskSum_.begin(), maskSum_.end(), 1);
+  // Owning task of each observation of the hyperslab
+  std::vector<int> partitionSlab(slabSize);
+  std::vector<int> sendCounts(comm_.size(), 0);
+  for (size_t jo = 0; jo < slabSize; ++jo) {
+    partitionSlab[jo] = geom_->generic().closestTask(static_cast<double>(latitude[jo]),
+                                                     static_cast<double>(longitude[jo]));
+    ++sendCounts[partitionSlab[jo]];
+  }
 
-    // Split observations between tasks
-    splitObservations(longitude, latitude);
+  // Position in the send buffer (observations sorted by owning task, file order preserved)
+  std::vector<int> sendDispls;
+  sendDispls.push_back(0);
+  for (size_t jt = 0; jt < comm_.size()-1; ++jt) {
+    sendDispls.push_back(sendDispls[jt]+sendCounts[jt]);
+  }
+  std::vector<size_t> sendIndex(slabSize);
+  std::vector<int> sendNext(sendDispls);
+  for (size_t jo = 0; jo < slabSize; ++jo) {
+    sendIndex[jo] = sendNext[partitionSlab[jo]]++;
+  }
 
-    // Get ordered time and location
-    timesGlb.resize(6*nobsGlb_);
-    locsGlb.resize(3*nobsGlb_);
-    std::vector<int> iobsOwnVec(comm_.size(), 0);
-    for (size_t jo = 0; jo < nobsGlb_; ++jo) {
-      size_t offset = 0;
-      for (int jt = 0; jt < partition_[jo]; ++jt) {
-        offset += nobsOwnVec_[jt];
+  // Record of each observation: dateTime, longitude, latitude, height, data of all groups
+  const size_t nrec = 4+dataGrpIds.size()*vars_.size();
+  std::vector<double> sendBuf(nrec*slabSize);
+  for (size_t jo = 0; jo < slabSize; ++jo) {
+    sendBuf[nrec*sendIndex[jo]+0] = static_cast<double>(dateTime[jo]);
+    sendBuf[nrec*sendIndex[jo]+1] = static_cast<double>(longitude[jo]);
+    sendBuf[nrec*sendIndex[jo]+2] = static_cast<double>(latitude[jo]);
+    sendBuf[nrec*sendIndex[jo]+3] = static_cast<double>(height[jo]);
+  }
+  std::vector<float> dataVar(slabSize);
+  for (size_t jgrp = 0; jgrp < dataGrpIds.size(); ++jgrp) {
+    for (size_t jvar = 0; jvar < vars_.size(); ++jvar) {
+      // Get data
+      if (retval = nc_inq_varid(dataGrpIds[jgrp], vars_[jvar].name().c_str(), &data_id))
+        ERR(retval, vars_[jvar].name());
+      if (retval = nc_get_vara_float(dataGrpIds[jgrp], data_id, &slabStart, &slabSize,
+        dataVar.data())) ERR(retval, vars_[jvar].name());
+      for (size_t jo = 0; jo < slabSize; ++jo) {
+        sendBuf[nrec*sendIndex[jo]+4+jgrp*vars_.size()+jvar] = static_cast<double>(dataVar[jo]);
       }
-      offset += iobsOwnVec[partition_[jo]];
-      util::DateTime startTest = start + util::Duration(dateTime[jo]);
-      startTest.toYYYYMMDDhhmmss(timesGlb[6*offset+0], timesGlb[6*offset+1], timesGlb[6*offset+2],
-        timesGlb[6*offset+3], timesGlb[6*offset+4], timesGlb[6*offset+5]);
-      locsGlb[3*offset+0] = static_cast<double>(longitude[jo]);
-      locsGlb[3*offset+1] = static_cast<double>(latitude[jo]);
-      locsGlb[3*offset+2] = static_cast<double>(height[jo]);
-      ++iobsOwnVec[partition_[jo]];
     }
   }
 
-  // Broadcast number of observations for each task
-  comm_.broadcast(nobsGlb_, 0);
-  comm_.broadcast(nobsOwnVec_, 0);
-  nobsOwn_ = nobsOwnVec_[comm_.rank()];
+  // Close file
+  if (retval = nc_close(ncid)) ERR(retval, ncFilePath);
 
-  // Allocation of local vectors
-  std::vector<int> timesOwn(6*nobsOwn_);
-  std::vector<double> locsOwn(3*nobsOwn_);
+  // Communicate sendCounts to get recvCounts
+  std::vector<int> recvCounts(comm_.size());
+  std::vector<int> tmpCounts(comm_.size(), 1);
+  std::vector<int> tmpDispls;
+  tmpDispls.push_back(0);
+  for (size_t jt = 0; jt < comm_.size()-1; ++jt) {
+    tmpDispls.push_back(tmpDispls[jt]+tmpCounts[jt]);
+  }
+  comm_.allToAllv(sendCounts.data(), tmpCounts.data(), tmpDispls.data(), recvCounts.data(),
+    tmpCounts.data(), tmpDispls.data());
 
-  // Define counts and displacements
-  std::vector<int> timesCounts;
-  std::vector<int> locsCounts;
-  std::vector<int> dataCounts;
-  std::vector<int> timesDispls;
-  std::vector<int> locsDispls;
-  std::vector<int> dataDispls;
-  for (size_t jt = 0; jt < comm_.size(); ++jt) {
-    timesCounts.push_back(6*nobsOwnVec_[jt]);
-    locsCounts.push_back(3*nobsOwnVec_[jt]);
-    dataCounts.push_back(vars_.size()*nobsOwnVec_[jt]);
+  // Number of observations for each task
+  nobsOwn_ = 0;
+  for (const auto & item : recvCounts) {
+    nobsOwn_ += item;
   }
-  timesDispls.push_back(0);
-  locsDispls.push_back(0);
-  dataDispls.push_back(0);
-  for (size_t jt = 0; jt < comm_.size()-1; ++jt) {
-    timesDispls.push_back(timesDispls[jt]+timesCounts[jt]);
-    locsDispls.push_back(locsDispls[jt]+locsCounts[jt]);
-    dataDispls.push_back(dataDispls[jt]+dataCounts[jt]);
+  nobsOwnVec_.resize(comm_.size());
+  comm_.allGather(nobsOwn_, nobsOwnVec_.begin(), nobsOwnVec_.end());
+
+  // Define records counts and displacements
+  std::vector<int> recSendCounts(comm_.size());
+  std::vector<int> recRecvCounts(comm_.size());
+  std::vector<int> recSendDispls(comm_.size());
+  std::vector<int> recRecvDispls(comm_.size());
+  recRecvDispls[0] = 0;
+  for (size_t jt = 0; jt < comm_.size(); ++jt) {
+    recSendCounts[jt] = nrec*sendCounts[jt];
+    recRecvCounts[jt] = nrec*recvCounts[jt];
+    recSendDispls[jt] = nrec*sendDispls[jt];
+    if (jt > 0) {
+      recRecvDispls[jt] = recRecvDispls[jt-1]+recRecvCounts[jt-1];
+    }
   }
 
-  // Scatter times and locations
-  comm_.scatterv(timesGlb.begin(), timesGlb.end(), timesCounts, timesDispls,
-    timesOwn.begin(), timesOwn.end(), 0);
-  comm_.scatterv(locsGlb.begin(), locsGlb.end(), locsCounts, locsDispls,
-    locsOwn.begin(), locsOwn.end(), 0);
+  // Redistribute records to the owning tasks
+  std::vector<double> recvBuf(nrec*nobsOwn_);
+  comm_.allToAllv(sendBuf.data(), recSendCounts.data(), recSendDispls.data(),
+    recvBuf.data(), recRecvCounts.data(), recRecvDispls.data());
 
   // Format local times and locations
   for (size_t jo = 0; jo < nobsOwn_; ++jo) {
-    times_.push_back(util::DateTime(timesOwn[6*jo], timesOwn[6*jo+1], timesOwn[6*jo+2],
-      timesOwn[6*jo+3], timesOwn[6*jo+4], timesOwn[6*jo+5]));
-    locs_.push_back(atlas::Point3(locsOwn[3*jo], locsOwn[3*jo+1], locsOwn[3*jo+2]));
+    times_.push_back(start + util::Duration(static_cast<int64_t>(recvBuf[nrec*jo])));
+    locs_.push_back(atlas::Point3(recvBuf[nrec*jo+1], recvBuf[nrec*jo+2], recvBuf[nrec*jo+3]));
   }
 
-  // Broadcast number of groups
-  comm_.broadcast(ngrp, 0);
-
-  for (int jgrp = 0; jgrp < ngrp; ++jgrp) {
-    // Get group name
-    std::string grpName;
-    size_t grpNameLen = 0;
-    if (comm_.rank() == 0) {
-      if (retval = nc_inq_grpname_len(group_ids[jgrp], &grpNameLen)) ERR(retval,
-        std::to_string(group_ids[jgrp]));
-      grpName.resize(grpNameLen);
-      if (retval = nc_inq_grpname(group_ids[jgrp], &grpName[0])) ERR(retval,
-        std::to_string(group_ids[jgrp]));
-    }
-    oops::mpi::broadcastString(comm_, grpName, 0);
-
-    if (grpName.substr(0, grpNameLen-1) != "MetaData") {
-      // Non-MetaData group
-      if (comm_.rank() == 0) {
-        std::vector<float> dataVar(nobsGlb_);
-        dataGlb.resize(vars_.size()*nobsGlb_);
-        for (size_t jvar = 0; jvar < vars_.size(); ++jvar) {
-          // Get data
-          if (retval = nc_inq_varid(group_ids[jgrp], vars_[jvar].name().c_str(), &data_id))
-            ERR(retval, vars_[jvar].name());
-          if (retval = nc_get_var_float(group_ids[jgrp], data_id, dataVar.data())) ERR(retval,
-            vars_[jvar].name());
-
-          // Get ordered data
-          std::vector<int> iobsOwnVec(comm_.size(), 0);
-          for (size_t jo = 0; jo < nobsGlb_; ++jo) {
-            size_t offset = 0;
-            for (int jt = 0; jt < partition_[jo]; ++jt) {
-              offset += nobsOwnVec_[jt];
-            }
-            offset += iobsOwnVec[partition_[jo]];
-            dataGlb[vars_.size()*offset+jvar] = static_cast<double>(dataVar[jo]);
-            ++iobsOwnVec[partition_[jo]];
-          }
-        }
-      }
-
-      // Allocation of local vector
-      std::vector<double> dataOwn(vars_.size()*nobsOwn_);
-
-      // Scatter data
-      comm_.scatterv(dataGlb.begin(), dataGlb.end(), dataCounts, dataDispls,
-        dataOwn.begin(), dataOwn.end(), 0);
-
-      // Format data
-      atlas::FieldSet fset;
-      fset.name() = grpName.substr(0, grpNameLen-1);
-      for (size_t jvar = 0; jvar < vars_.size(); ++jvar) {
-        atlas::Field field(vars_[jvar].name(), atlas::array::make_datatype<double>(),
-          atlas::array::make_shape(nobsOwn_, 1));
-        auto view = atlas::array::make_view<double, 2>(field);
-        for (size_t jo = 0; jo < nobsOwn_; ++jo) {
-          view(jo, 0) = dataOwn[jo*vars_.size()+jvar];
-        }
-        fset.add(field);
+  // Format data
+  for (size_t jgrp = 0; jgrp < dataGrpIds.size(); ++jgrp) {
+    atlas::FieldSet fset;
+    fset.name() = dataGrpNames[jgrp];
+    for (size_t jvar = 0; jvar < vars_.size(); ++jvar) {
+      atlas::Field field(vars_[jvar].name(), atlas::array::make_datatype<double>(),
+        atlas::array::make_shape(nobsOwn_, 1));
+      auto view = atlas::array::make_view<double, 2>(field);
+      for (size_t jo = 0; jo < nobsOwn_; ++jo) {
+        view(jo, 0) = recvBuf[nrec*jo+4+jgrp*vars_.size()+jvar];
       }
-      data_.emplace_back(fset);
+      fset.add(field);
     }
+    data_.emplace_back(fset);
   }
 
+  // Gather locations order and set mask on main task
   if (comm_.rank() == 0) {
-    // Close file
-    if (retval = nc_close(ncid)) ERR(retval, ncFilePath);
+    order_.resize(nobsGlb_);
+    mask_.resize(nobsGlb_);
+    maskSum_.resize(nobsGlb_);
+    std::fill(mask_.begin(), mask_.end(), 1);
+    std::fill(maskSum_.begin(), maskSum_.end(), 1);
   }
+  comm_.gatherv(orderSlab, order_, slabCounts, slabDispls, 0);
 
   // Setup halo
   setupHalo();
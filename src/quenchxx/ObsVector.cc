@@ -244,6 +244,43 @@ void ObsVector::random() {
 double ObsVector::dot_product_with(const ObsVector & other) const {
   oops::Log::trace() << classname() << "::dot_product_with starting" << std::endl;
 
+  double zz = localDotProductWith(other);
+  comm_.allReduceInPlace(zz, eckit::mpi::sum());
+
+  oops::Log::trace() << classname() << "::dot_product_with done" << std::endl;
+  return zz;
+}
+
+// -----------------------------------------------------------------------------
+
+std::vector<double> ObsVector::dot_products_with(const std::vector<const ObsVector*> & others)
+  const {
+  oops::Log::trace() << classname() << "::dot_products_with starting" << std::endl;
+
+  // Nothing to reduce
+  if (others.empty()) {
+    oops::Log::trace() << classname() << "::dot_products_with done" << std::endl;
+    return std::vector<double>();
+  }
+
+  // Local dot products
+  std::vector<double> zz;
+  for (const auto & other : others) {
+    zz.push_back(localDotProductWith(*other));
+  }
+
+  // Single reduction
+  comm_.allReduceInPlace(zz.begin(), zz.end(), eckit::mpi::sum());
+
+  oops::Log::trace() << classname() << "::dot_products_with done" << std::endl;
+  return zz;
+}
+
+// -----------------------------------------------------------------------------
+
+double ObsVector::localDotProductWith(const ObsVector & other) const {
+  oops::Log::trace() << classname() << "::localDotProductWith starting" << std::endl;
+
   double zz = 0;
   for (size_t jvar = 0; jvar < vars_.size(); ++jvar) {
     const atlas::Field field = data_[vars_[jvar].name()];
@@ -254,9 +291,8 @@ double ObsVector::dot_product_with(const ObsVector & other) const {
       zz += view(jo, 0)*otherView(jo, 0);
     }
   }
-  comm_.allReduceInPlace(zz, eckit::mpi::sum());
 
-  oops::Log::trace() << classname() << "::dot_product_with done" << std::endl;
+  oops::Log::trace() << classname() << "::localDotProductWith done" << std::endl;
   return zz;
 }
 
@@ -49,6 +49,7 @@ class ObsVector : public util::Printable,
   void invert();
   void random();
   double dot_product_with(const ObsVector &) const;
+  std::vector<double> dot_products_with(const std::vector<const ObsVector*> &) const;
   double rms() const;
   void mask(const ObsVector &);
   void sqrt();
@@ -82,6 +83,7 @@ class ObsVector : public util::Printable,
 
  private:
   void print(std::ostream &) const;
+  double localDotProductWith(const ObsVector &) const;
 
   const eckit::mpi::Comm & comm_;
   const ObsSpace & obsSpace_;
@@ -0,0 +1,497 @@
+/*
+ * (C) Copyright 2025 Meteorologisk Institutt
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#include "quenchxx/SimdKernels.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define QUENCHXX_X86_SIMD
+#include <immintrin.h>
+#endif
+
+#include "eckit/exception/Exceptions.h"
+
+namespace quenchxx {
+
+// -----------------------------------------------------------------------------
+/// Kernels table
+
+struct KernelsTable {
+  const char * isa;
+  void (*add)(const size_t, const double *, double *);
+  void (*sub)(const size_t, const double *, double *);
+  void (*scale)(const size_t, const double, double *);
+  void (*axpy)(const size_t, const double, const double *, double *);
+  void (*schur)(const size_t, const double *, double *);
+  double (*dot)(const size_t, const double *, const double *);
+  void (*minMax)(const size_t, const double *, double &, double &);
+};
+
+// -----------------------------------------------------------------------------
+/// Scalar kernels
+
+static void scalarAdd(const size_t n, const double * x, double * y) {
+  for (size_t j = 0; j < n; ++j) y[j] += x[j];
+}
+
+static void scalarSub(const size_t n, const double * x, double * y) {
+  for (size_t j = 0; j < n; ++j) y[j] -= x[j];
+}
+
+static void scalarScale(const size_t n, const double a, double * y) {
+  for (size_t j = 0; j < n; ++j) y[j] *= a;
+}
+
+static void scalarAxpy(const size_t n, const double a, const double * x, double * y) {
+  for (size_t j = 0; j < n; ++j) y[j] += a*x[j];
+}
+
+static void scalarSchur(const size_t n, const double * x, double * y) {
+  for (size_t j = 0; j < n; ++j) y[j] *= x[j];
+}
+
+// Dot products of all instruction sets use the same summation order: eight partial sums over
+// blocks of 8 values (partial sum k accumulates values j such that j%8 == k), combined pairwise,
+// then the remainder added sequentially
+
+static double scalarDot(const size_t n, const double * x, const double * y) {
+  double sum[8] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  size_t j = 0;
+  for (; j+8 <= n; j += 8) {
+    for (size_t k = 0; k < 8; ++k) sum[k] += x[j+k]*y[j+k];
+  }
+  double zz = ((sum[0]+sum[1])+(sum[2]+sum[3]))+((sum[4]+sum[5])+(sum[6]+sum[7]));
+  for (; j < n; ++j) zz += x[j]*y[j];
+  return zz;
+}
+
+static void scalarMinMax(const size_t n, const double * x, double & zmin, double & zmax) {
+  for (size_t j = 0; j < n; ++j) {
+    zmin = std::min(zmin, x[j]);
+    zmax = std::max(zmax, x[j]);
+  }
+}
+
+static const KernelsTable scalarTable = {"scalar", scalarAdd, scalarSub, scalarScale, scalarAxpy,
+  scalarSchur, scalarDot, scalarMinMax};
+
+#ifdef QUENCHXX_X86_SIMD
+
+// -----------------------------------------------------------------------------
+/// SSE4.1 kernels (2 doubles per register, scalar remainder)
+
+__attribute__((target("sse4.1")))
+static void sse4Add(const size_t n, const double * x, double * y) {
+  size_t j = 0;
+  for (; j+2 <= n; j += 2) {
+    _mm_storeu_pd(y+j, _mm_add_pd(_mm_loadu_pd(y+j), _mm_loadu_pd(x+j)));
+  }
+  for (; j < n; ++j) y[j] += x[j];
+}
+
+__attribute__((target("sse4.1")))
+static void sse4Sub(const size_t n, const double * x, double * y) {
+  size_t j = 0;
+  for (; j+2 <= n; j += 2) {
+    _mm_storeu_pd(y+j, _mm_sub_pd(_mm_loadu_pd(y+j), _mm_loadu_pd(x+j)));
+  }
+  for (; j < n; ++j) y[j] -= x[j];
+}
+
+__attribute__((target("sse4.1")))
+static void sse4Scale(const size_t n, const double a, double * y) {
+  const __m128d va = _mm_set1_pd(a);
+  size_t j = 0;
+  for (; j+2 <= n; j += 2) {
+    _mm_storeu_pd(y+j, _mm_mul_pd(_mm_loadu_pd(y+j), va));
+  }
+  for (; j < n; ++j) y[j] *= a;
+}
+
+__attribute__((target("sse4.1")))
+static void sse4Axpy(const size_t n, const double a, const double * x, double * y) {
+  const __m128d va = _mm_set1_pd(a);
+  size_t j = 0;
+  for (; j+2 <= n; j += 2) {
+    _mm_storeu_pd(y+j, _mm_add_pd(_mm_loadu_pd(y+j), _mm_mul_pd(va, _mm_loadu_pd(x+j))));
+  }
+  for (; j < n; ++j) y[j] += a*x[j];
+}
+
+__attribute__((target("sse4.1")))
+static void sse4Schur(const size_t n, const double * x, double * y) {
+  size_t j = 0;
+  for (; j+2 <= n; j += 2) {
+    _mm_storeu_pd(y+j, _mm_mul_pd(_mm_loadu_pd(y+j), _mm_loadu_pd(x+j)));
+  }
+  for (; j < n; ++j) y[j] *= x[j];
+}
+
+__attribute__((target("sse4.1")))
+static double sse4Dot(const size_t n, const double * x, const double * y) {
+  __m128d vsum[4] = {_mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd()};
+  size_t j = 0;
+  for (; j+8 <= n; j += 8) {
+    for (size_t k = 0; k < 4; ++k) {
+      vsum[k] = _mm_add_pd(vsum[k], _mm_mul_pd(_mm_loadu_pd(x+j+2*k), _mm_loadu_pd(y+j+2*k)));
+    }
+  }
+  double sum[8];
+  for (size_t k = 0; k < 4; ++k) _mm_storeu_pd(sum+2*k, vsum[k]);
+  double zz = ((sum[0]+sum[1])+(sum[2]+sum[3]))+((sum[4]+sum[5])+(sum[6]+sum[7]));
+  for (; j < n; ++j) zz += x[j]*y[j];
+  return zz;
+}
+
+__attribute__((target("sse4.1")))
+static void sse4MinMax(const size_t n, const double * x, double & zmin, double & zmax) {
+  __m128d vmin = _mm_set1_pd(zmin);
+  __m128d vmax = _mm_set1_pd(zmax);
+  size_t j = 0;
+  for (; j+2 <= n; j += 2) {
+    const __m128d vx = _mm_loadu_pd(x+j);
+    vmin = _mm_min_pd(vmin, vx);
+    vmax = _mm_max_pd(vmax, vx);
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, vmin);
+  zmin = std::min(lanes[0], lanes[1]);
+  _mm_storeu_pd(lanes, vmax);
+  zmax = std::max(lanes[0], lanes[1]);
+  for (; j < n; ++j) {
+    zmin = std::min(zmin, x[j]);
+    zmax = std::max(zmax, x[j]);
+  }
+}
+
+static const KernelsTable sse4Table = {"sse4", sse4Add, sse4Sub, sse4Scale, sse4Axpy, sse4Schur,
+  sse4Dot, sse4MinMax};
+
+// -----------------------------------------------------------------------------
+/// AVX2 kernels (4 doubles per register, scalar remainder)
+
+__attribute__((target("avx2")))
+static void avx2Add(const size_t n, const double * x, double * y) {
+  size_t j = 0;
+  for (; j+4 <= n; j += 4) {
+    _mm256_storeu_pd(y+j, _mm256_add_pd(_mm256_loadu_pd(y+j), _mm256_loadu_pd(x+j)));
+  }
+  for (; j < n; ++j) y[j] += x[j];
+}
+
+__attribute__((target("avx2")))
+static void avx2Sub(const size_t n, const double * x, double * y) {
+  size_t j = 0;
+  for (; j+4 <= n; j += 4) {
+    _mm256_storeu_pd(y+j, _mm256_sub_pd(_mm256_loadu_pd(y+j), _mm256_loadu_pd(x+j)));
+  }
+  for (; j < n; ++j) y[j] -= x[j];
+}
+
+__attribute__((target("avx2")))
+static void avx2Scale(const size_t n, const double a, double * y) {
+  const __m256d va = _mm256_set1_pd(a);
+  size_t j = 0;
+  for (; j+4 <= n; j += 4) {
+    _mm256_storeu_pd(y+j, _mm256_mul_pd(_mm256_loadu_pd(y+j), va));
+  }
+  for (; j < n; ++j) y[j] *= a;
+}
+
+__attribute__((target("avx2")))
+static void avx2Axpy(const size_t n, const double a, const double * x, double * y) {
+  const __m256d va = _mm256_set1_pd(a);
+  size_t j = 0;
+  for (; j+4 <= n; j += 4) {
+    _mm256_storeu_pd(y+j, _mm256_add_pd(_mm256_loadu_pd(y+j),
+      _mm256_mul_pd(va, _mm256_loadu_pd(x+j))));
+  }
+  for (; j < n; ++j) y[j] += a*x[j];
+}
+
+__attribute__((target("avx2")))
+static void avx2Schur(const size_t n, const double * x, double * y) {
+  size_t j = 0;
+  for (; j+4 <= n; j += 4) {
+    _mm256_storeu_pd(y+j, _mm256_mul_pd(_mm256_loadu_pd(y+j), _mm256_loadu_pd(x+j)));
+  }
+  for (; j < n; ++j) y[j] *= x[j];
+}
+
+__attribute__((target("avx2")))
+static double avx2Dot(const size_t n, const double * x, const double * y) {
+  __m256d vsum0 = _mm256_setzero_pd();
+  __m256d vsum1 = _mm256_setzero_pd();
+  size_t j = 0;
+  for (; j+8 <= n; j += 8) {
+    vsum0 = _mm256_add_pd(vsum0, _mm256_mul_pd(_mm256_loadu_pd(x+j), _mm256_loadu_pd(y+j)));
+    vsum1 = _mm256_add_pd(vsum1, _mm256_mul_pd(_mm256_loadu_pd(x+j+4), _mm256_loadu_pd(y+j+4)));
+  }
+  double sum[8];
+  _mm256_storeu_pd(sum, vsum0);
+  _mm256_storeu_pd(sum+4, vsum1);
+  double zz = ((sum[0]+sum[1])+(sum[2]+sum[3]))+((sum[4]+sum[5])+(sum[6]+sum[7]));
+  for (; j < n; ++j) zz += x[j]*y[j];
+  return zz;
+}
+
+__attribute__((target("avx2")))
+static void avx2MinMax(const size_t n, const double * x, double & zmin, double & zmax) {
+  __m256d vmin = _mm256_set1_pd(zmin);
+  __m256d vmax = _mm256_set1_pd(zmax);
+  size_t j = 0;
+  for (; j+4 <= n; j += 4) {
+    const __m256d vx = _mm256_loadu_pd(x+j);
+    vmin = _mm256_min_pd(vmin, vx);
+    vmax = _mm256_max_pd(vmax, vx);
+  }
+  double lanes[4];
+  _mm256_storeu_pd(lanes, vmin);
+  zmin = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+  _mm256_storeu_pd(lanes, vmax);
+  zmax = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+  for (; j < n; ++j) {
+    zmin = std::min(zmin, x[j]);
+    zmax = std::max(zmax, x[j]);
+  }
+}
+
+static const KernelsTable avx2Table = {"avx2", avx2Add, avx2Sub, avx2Scale, avx2Axpy, avx2Schur,
+  avx2Dot, avx2MinMax};
+
+// -----------------------------------------------------------------------------
+/// AVX-512 kernels (8 doubles per register, masked remainder)
+
+__attribute__((target("avx512f")))
+static void avx512Add(const size_t n, const double * x, double * y) {
+  size_t j = 0;
+  for (; j+8 <= n; j += 8) {
+    _mm512_storeu_pd(y+j, _mm512_add_pd(_mm512_loadu_pd(y+j), _mm512_loadu_pd(x+j)));
+  }
+  if (j < n) {
+    const __mmask8 m = static_cast<__mmask8>((1u << (n-j))-1);
+    _mm512_mask_storeu_pd(y+j, m, _mm512_add_pd(_mm512_maskz_loadu_pd(m, y+j),
+      _mm512_maskz_loadu_pd(m, x+j)));
+  }
+}
+
+__attribute__((target("avx512f")))
+static void avx512Sub(const size_t n, const double * x, double * y) {
+  size_t j = 0;
+  for (; j+8 <= n; j += 8) {
+    _mm512_storeu_pd(y+j, _mm512_sub_pd(_mm512_loadu_pd(y+j), _mm512_loadu_pd(x+j)));
+  }
+  if (j < n) {
+    const __mmask8 m = static_cast<__mmask8>((1u << (n-j))-1);
+    _mm512_mask_storeu_pd(y+j, m, _mm512_sub_pd(_mm512_maskz_loadu_pd(m, y+j),
+      _mm512_maskz_loadu_pd(m, x+j)));
+  }
+}
+
+__attribute__((target("avx512f")))
+static void avx512Scale(const size_t n, const double a, double * y) {
+  const __m512d va = _mm512_set1_pd(a);
+  size_t j = 0;
+  for (; j+8 <= n; j += 8) {
+    _mm512_storeu_pd(y+j, _mm512_mul_pd(_mm512_loadu_pd(y+j), va));
+  }
+  if (j < n) {
+    const __mmask8 m = static_cast<__mmask8>((1u << (n-j))-1);
+    _mm512_mask_storeu_pd(y+j, m, _mm512_mul_pd(_mm512_maskz_loadu_pd(m, y+j), va));
+  }
+}
+
+__attribute__((target("avx512f")))
+static void avx512Axpy(const size_t n, const double a, const double * x, double * y) {
+  const __m512d va = _mm512_set1_pd(a);
+  size_t j = 0;
+  for (; j+8 <= n; j += 8) {
+    _mm512_storeu_pd(y+j, _mm512_add_pd(_mm512_loadu_pd(y+j),
+      _mm512_mul_pd(va, _mm512_loadu_pd(x+j))));
+  }
+  if (j < n) {
+    const __mmask8 m = static_cast<__mmask8>((1u << (n-j))-1);
+    _mm512_mask_storeu_pd(y+j, m, _mm512_add_pd(_mm512_maskz_loadu_pd(m, y+j),
+      _mm512_mul_pd(va, _mm512_maskz_loadu_pd(m, x+j))));
+  }
+}
+
+__attribute__((target("avx512f")))
+static void avx512Schur(const size_t n, const double * x, double * y) {
+  size_t j = 0;
+  for (; j+8 <= n; j += 8) {
+    _mm512_storeu_pd(y+j, _mm512_mul_pd(_mm512_loadu_pd(y+j), _mm512_loadu_pd(x+j)));
+  }
+  if (j < n) {
+    const __mmask8 m = static_cast<__mmask8>((1u << (n-j))-1);
+    _mm512_mask_storeu_pd(y+j, m, _mm512_mul_pd(_mm512_maskz_loadu_pd(m, y+j),
+      _mm512_maskz_loadu_pd(m, x+j)));
+  }
+}
+
+__attribute__((target("avx512f")))
+static double avx512Dot(const size_t n, const double * x, const double * y) {
+  __m512d vsum = _mm512_setzero_pd();
+  size_t j = 0;
+  for (; j+8 <= n; j += 8) {
+    vsum = _mm512_add_pd(vsum, _mm512_mul_pd(_mm512_loadu_pd(x+j), _mm512_loadu_pd(y+j)));
+  }
+  double sum[8];
+  _mm512_storeu_pd(sum, vsum);
+  double zz = ((sum[0]+sum[1])+(sum[2]+sum[3]))+((sum[4]+sum[5])+(sum[6]+sum[7]));
+  for (; j < n; ++j) zz += x[j]*y[j];
+  return zz;
+}
+
+__attribute__((target("avx512f")))
+static void avx512MinMax(const size_t n, const double * x, double & zmin, double & zmax) {
+  __m512d vmin = _mm512_set1_pd(zmin);
+  __m512d vmax = _mm512_set1_pd(zmax);
+  size_t j = 0;
+  for (; j+8 <= n; j += 8) {
+    const __m512d vx = _mm512_loadu_pd(x+j);
+    vmin = _mm512_mask_min_pd(vmin, 0xFF, vmin, vx);
+    vmax = _mm512_mask_max_pd(vmax, 0xFF, vmax, vx);
+  }
+  if (j < n) {
+    // Masked lanes keep their current extrema
+    const __mmask8 m = static_cast<__mmask8>((1u << (n-j))-1);
+    const __m512d vx = _mm512_maskz_loadu_pd(m, x+j);
+    vmin = _mm512_mask_min_pd(vmin, m, vmin, vx);
+    vmax = _mm512_mask_max_pd(vmax, m, vmax, vx);
+  }
+  double lanes[8];
+  _mm512_storeu_pd(lanes, vmin);
+  zmin = *std::min_element(lanes, lanes+8);
+  _mm512_storeu_pd(lanes, vmax);
+  zmax = *std::max_element(lanes, lanes+8);
+}
+
+static const KernelsTable avx512Table = {"avx512", avx512Add, avx512Sub, avx512Scale, avx512Axpy,
+  avx512Schur, avx512Dot, avx512MinMax};
+
+#endif  // QUENCHXX_X86_SIMD
+
+// -----------------------------------------------------------------------------
+/// Instruction set selection
+
+static const KernelsTable * bestKernelsTable() {
+#ifdef QUENCHXX_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return &avx512Table;
+  if (__builtin_cpu_supports("avx2")) return &avx2Table;
+  if (__builtin_cpu_supports("sse4.1")) return &sse4Table;
+#endif
+  return &scalarTable;
+}
+
+// -----------------------------------------------------------------------------
+
+static std::atomic<const KernelsTable *> & activeKernelsTable() {
+  static std::atomic<const KernelsTable *> table(bestKernelsTable());
+  return table;
+}
+
+// -----------------------------------------------------------------------------
+
+std::string kernelsIsa() {
+  return activeKernelsTable().load()->isa;
+}
+
+// -----------------------------------------------------------------------------
+
+void setKernelsIsa(const std::string & isa) {
+  const KernelsTable * table = nullptr;
+  if (isa == "auto") {
+    table = bestKernelsTable();
+  } else if (isa == "scalar") {
+    table = &scalarTable;
+#ifdef QUENCHXX_X86_SIMD
+  } else if (isa == "sse4" && __builtin_cpu_supports("sse4.1")) {
+    table = &sse4Table;
+  } else if (isa == "avx2" && __builtin_cpu_supports("avx2")) {
+    table = &avx2Table;
+  } else if (isa == "avx512" && __builtin_cpu_supports("avx512f")) {
+    table = &avx512Table;
+#endif
+  } else {
+    throw eckit::UserError("kernels instruction set " + isa + " not supported", Here());
+  }
+  activeKernelsTable().store(table);
+}
+
+// -----------------------------------------------------------------------------
+/// Double precision kernels
+
+template <>
+void kernelAdd(const size_t & n,
+               const double * x,
+               double * y) {
+  activeKernelsTable().load()->add(n, x, y);
+}
+
+// -----------------------------------------------------------------------------
+
+template <>
+void kernelSub(const size_t & n,
+               const double * x,
+               double * y) {
+  activeKernelsTable().load()->sub(n, x, y);
+}
+
+// -----------------------------------------------------------------------------
+
+template <>
+void kernelScale(const size_t & n,
+                 const double & a,
+                 double * y) {
+  activeKernelsTable().load()->scale(n, a, y);
+}
+
+// -----------------------------------------------------------------------------
+
+template <>
+void kernelAxpy(const size_t & n,
+                const double & a,
+                const double * x,
+                double * y) {
+  activeKernelsTable().load()->axpy(n, a, x, y);
+}
+
+// -----------------------------------------------------------------------------
+
+template <>
+void kernelSchur(const size_t & n,
+                 const double * x,
+                 double * y) {
+  activeKernelsTable().load()->schur(n, x, y);
+}
+
+// -----------------------------------------------------------------------------
+
+template <>
+double kernelDot(const size_t & n,
+                 const double * x,
+                 const double * y) {
+  return activeKernelsTable().load()->dot(n, x, y);
+}
+
+// -----------------------------------------------------------------------------
+
+template <>
+void kernelMinMax(const size_t & n,
+                  const double * x,
+                  double & zmin,
+                  double & zmax) {
+  activeKernelsTable().load()->minMax(n, x, zmin, zmax);
+}
+
+// -----------------------------------------------------------------------------
+
+}  // namespace quenchxx
@@ -0,0 +1,119 @@
+/*
+ * (C) Copyright 2025 Meteorologisk Institutt
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <string>
+
+namespace quenchxx {
+
+// -----------------------------------------------------------------------------
+/// Fields arithmetic kernels on contiguous ranges of n values (e.g. mask segments)
+/// Generic versions are used for single precision storage, double precision versions use explicit
+/// SIMD instructions selected at runtime (SSE4.1, AVX2 or AVX-512 on x86-64, scalar otherwise).
+/// Double precision results do not depend on the instruction set: no fused multiply-add, and the
+/// same summation order for dot products.
+
+// y += x
+template <typename T>
+void kernelAdd(const size_t & n,
+               const T * x,
+               T * y) {
+  for (size_t j = 0; j < n; ++j) {
+    y[j] += x[j];
+  }
+}
+
+// y -= x
+template <typename T>
+void kernelSub(const size_t & n,
+               const T * x,
+               T * y) {
+  for (size_t j = 0; j < n; ++j) {
+    y[j] -= x[j];
+  }
+}
+
+// y *= a
+template <typename T>
+void kernelScale(const size_t & n,
+                 const double & a,
+                 T * y) {
+  for (size_t j = 0; j < n; ++j) {
+    y[j] *= a;
+  }
+}
+
+// y += a*x
+template <typename T>
+void kernelAxpy(const size_t & n,
+                const double & a,
+                const T * x,
+                T * y) {
+  for (size_t j = 0; j < n; ++j) {
+    y[j] += a*x[j];
+  }
+}
+
+// y *= x
+template <typename T>
+void kernelSchur(const size_t & n,
+                 const T * x,
+                 T * y) {
+  for (size_t j = 0; j < n; ++j) {
+    y[j] *= x[j];
+  }
+}
+
+// Sum of x*y, accumulated in double precision
+template <typename T>
+double kernelDot(const size_t & n,
+                 const T * x,
+                 const T * y) {
+  double zz = 0.0;
+  for (size_t j = 0; j < n; ++j) {
+    zz += static_cast<double>(x[j])*static_cast<double>(y[j]);
+  }
+  return zz;
+}
+
+// Update minimum and maximum with x values
+template <typename T>
+void kernelMinMax(const size_t & n,
+                  const T * x,
+                  double & zmin,
+                  double & zmax) {
+  for (size_t j = 0; j < n; ++j) {
+    zmin = std::min(zmin, static_cast<double>(x[j]));
+    zmax = std::max(zmax, static_cast<double>(x[j]));
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// Double precision versions, dispatched at runtime
+
+template <> void kernelAdd(const size_t &, const double *, double *);
+template <> void kernelSub(const size_t &, const double *, double *);
+template <> void kernelScale(const size_t &, const double &, double *);
+template <> void kernelAxpy(const size_t &, const double &, const double *, double *);
+template <> void kernelSchur(const size_t &, const double *, double *);
+template <> double kernelDot(const size_t &, const double *, const double *);
+template <> void kernelMinMax(const size_t &, const double *, double &, double &);
+
+// -----------------------------------------------------------------------------
+/// Instruction set of the double precision kernels: "scalar", "sse4", "avx2" or "avx512"
+
+// Current instruction set (the best one supported by the CPU by default)
+std::string kernelsIsa();
+
+// Force an instruction set ("auto" for the best one supported), throw if it is not supported
+void setKernelsIsa(const std::string &);
+
+// -----------------------------------------------------------------------------
+
+}  // namespace quenchxx
@@ -8,6 +8,7 @@
 
 #include "quenchxx/State.h"
 
+#include <utility>
 #include <vector>
 
 #include "eckit/exception/Exceptions.h"
@@ -71,7 +72,24 @@ State::State(const Geometry & resol,
 State & State::operator=(const State & rhs) {
   oops::Log::trace() << classname() << "::operator= starting" << std::endl;
 
-  fields_.reset(new Fields(*rhs.fields_));
+  if (fields_ && fields_->compatibleWith(*rhs.fields_)) {
+    // Copy into existing fields
+    *fields_ = *rhs.fields_;
+  } else {
+    // Reallocate fields
+    fields_.reset(new Fields(*rhs.fields_));
+  }
+
+  oops::Log::trace() << classname() << "::operator= done" << std::endl;
+  return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+State & State::operator=(State && rhs) {
+  oops::Log::trace() << classname() << "::operator= starting" << std::endl;
+
+  fields_ = std::move(rhs.fields_);
 
   oops::Log::trace() << classname() << "::operator= done" << std::endl;
   return *this;
@@ -11,6 +11,7 @@
 #include <memory>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "oops/util/DateTime.h"
@@ -55,6 +56,8 @@ class State : public util::Printable,
     : fields_(new Fields(*other.fields_)) {}
   State(const State & other)
     : fields_(new Fields(*other.fields_)) {}
+  State(State && other)
+    : fields_(std::move(other.fields_)) {}
   State(const Geometry & resol,
         const Model &,
         const eckit::Configuration & conf)
@@ -75,6 +78,7 @@ class State : public util::Printable,
 
   // Assignment
   State & operator=(const State &);
+  State & operator=(State &&);
 
   // Interactions with Increment
   State & operator+=(const Increment &);
@@ -5,7 +5,13 @@
 
 #include "quenchxx/Utilities.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
 #include "atlas/array.h"
+#include "atlas/functionspace.h"
 
 #include "eckit/exception/Exceptions.h"
 
@@ -15,6 +21,57 @@ namespace quenchxx {
 
 // -----------------------------------------------------------------------------
 
+void copyFieldData(const atlas::Field & src,
+                   atlas::Field & dst) {
+  // Check fields consistency
+  ASSERT(src.rank() == 2);
+  ASSERT(dst.rank() == 2);
+  ASSERT(src.shape(0) == dst.shape(0));
+  ASSERT(src.shape(1) == dst.shape(1));
+
+  // Copy data, converting storage type if needed
+  visitFieldStorage(src, [&](auto srcTag) {
+    using S = decltype(srcTag);
+    visitFieldStorage(dst, [&](auto dstTag) {
+      using D = decltype(dstTag);
+      const auto srcView = atlas::array::make_view<const S, 2>(src);
+      auto dstView = atlas::array::make_view<D, 2>(dst);
+      for (atlas::idx_t jnode = 0; jnode < src.shape(0); ++jnode) {
+        for (atlas::idx_t jlevel = 0; jlevel < src.shape(1); ++jlevel) {
+          dstView(jnode, jlevel) = static_cast<D>(srcView(jnode, jlevel));
+        }
+      }
+    });
+  });
+  dst.set_dirty(src.dirty());
+}
+
+// -----------------------------------------------------------------------------
+
+atlas::FieldSet copyFieldSetToDouble(const atlas::FieldSet & fset) {
+  atlas::FieldSet fsetDouble;
+  for (const auto & field : fset) {
+    if (field.rank() != 2) {
+      throw eckit::Exception("copyFieldSetToDouble: wrong rank", Here());
+    }
+
+    // Create double precision field
+    atlas::Field fieldDouble = field.functionspace().createField<double>(
+      atlas::option::name(field.name()) | atlas::option::levels(field.shape(1)));
+
+    // Copy metadata and data
+    fieldDouble.metadata() = field.metadata();
+    copyFieldData(field, fieldDouble);
+    fsetDouble.add(fieldDouble);
+  }
+
+  // Copy fieldset name
+  fsetDouble.name() = fset.name();
+  return fsetDouble;
+}
+
+// -----------------------------------------------------------------------------
+
 void copyFieldSetWithoutFunctionSpace(const atlas::FieldSet & otherFset,
                                       atlas::FieldSet & fset) {
   fset.clear();
@@ -52,10 +109,9 @@ void copyFieldSetWithoutFunctionSpace(const atlas::FieldSet & otherFset,
 
 // -----------------------------------------------------------------------------
 
-double dotProductFieldSetsWithoutFunctionSpace(const atlas::FieldSet & fset1,
-                                               const atlas::FieldSet & fset2,
-                                               const std::vector<std::string> & vars,
-                                               const eckit::mpi::Comm & comm) {
+double localDotProductFieldSetsWithoutFunctionSpace(const atlas::FieldSet & fset1,
+                                                    const atlas::FieldSet & fset2,
+                                                    const std::vector<std::string> & vars) {
   // Compute dot product
   double dp = 0.0;
 
@@ -89,6 +145,19 @@ double dotProductFieldSetsWithoutFunctionSpace(const atlas::FieldSet & fset1,
     }
   }
 
+  // Return local dot product
+  return dp;
+}
+
+// -----------------------------------------------------------------------------
+
+double dotProductFieldSetsWithoutFunctionSpace(const atlas::FieldSet & fset1,
+                                               const atlas::FieldSet & fset2,
+                                               const std::vector<std::string> & vars,
+                                               const eckit::mpi::Comm & comm) {
+  // Compute local dot product
+  double dp = localDotProductFieldSetsWithoutFunctionSpace(fset1, fset2, vars);
+
   // Allreduce
   comm.allReduceInPlace(dp, eckit::mpi::sum());
 
@@ -98,4 +167,204 @@ double dotProductFieldSetsWithoutFunctionSpace(const atlas::FieldSet & fset1,
 
 // -----------------------------------------------------------------------------
 
+std::vector<double> dotProductsFieldSetsWithoutFunctionSpace(
+  const atlas::FieldSet & fset1,
+  const std::vector<const atlas::FieldSet*> & fsets2,
+  const std::vector<std::string> & vars,
+  const eckit::mpi::Comm & comm) {
+  // Nothing to reduce
+  if (fsets2.empty()) {
+    return std::vector<double>();
+  }
+
+  // Compute local dot products
+  std::vector<double> dp;
+  for (const auto & fset2 : fsets2) {
+    dp.push_back(localDotProductFieldSetsWithoutFunctionSpace(fset1, *fset2, vars));
+  }
+
+  // Single allreduce
+  comm.allReduceInPlace(dp.begin(), dp.end(), eckit::mpi::sum());
+
+  // Return dot products
+  return dp;
+}
+
+// -----------------------------------------------------------------------------
+
+double counterBasedNormal(const uint64_t & seed,
+                          const uint64_t & gidx,
+                          const uint32_t & level,
+                          const uint32_t & key) {
+  // Philox4x32 constants
+  const uint32_t mult0 = 0xD2511F53;
+  const uint32_t mult1 = 0xCD9E8D57;
+  const uint32_t weyl0 = 0x9E3779B9;
+  const uint32_t weyl1 = 0xBB67AE85;
+
+  // Counter and key
+  uint32_t ctr[4] = {static_cast<uint32_t>(gidx), static_cast<uint32_t>(gidx >> 32), level, key};
+  uint32_t k0 = static_cast<uint32_t>(seed);
+  uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+
+  // Ten rounds
+  for (size_t jround = 0; jround < 10; ++jround) {
+    const uint64_t prod0 = static_cast<uint64_t>(mult0)*ctr[0];
+    const uint64_t prod1 = static_cast<uint64_t>(mult1)*ctr[2];
+    const uint32_t hi0 = static_cast<uint32_t>(prod0 >> 32);
+    const uint32_t lo0 = static_cast<uint32_t>(prod0);
+    const uint32_t hi1 = static_cast<uint32_t>(prod1 >> 32);
+    const uint32_t lo1 = static_cast<uint32_t>(prod1);
+    ctr[0] = hi1^ctr[1]^k0;
+    ctr[1] = lo1;
+    ctr[2] = hi0^ctr[3]^k1;
+    ctr[3] = lo0;
+    k0 += weyl0;
+    k1 += weyl1;
+  }
+
+  // Two uniform numbers in (0,1) with 53-bit resolution
+  const double scale = 1.0/9007199254740992.0;
+  const uint64_t bits1 = (static_cast<uint64_t>(ctr[0]) << 21)^(ctr[1] >> 11);
+  const uint64_t bits2 = (static_cast<uint64_t>(ctr[2]) << 21)^(ctr[3] >> 11);
+  const double u1 = (static_cast<double>(bits1 & 0x1FFFFFFFFFFFFF)+0.5)*scale;
+  const double u2 = (static_cast<double>(bits2 & 0x1FFFFFFFFFFFFF)+0.5)*scale;
+
+  // Box-Muller transform
+  return std::sqrt(-2.0*std::log(u1))*std::cos(2.0*M_PI*u2);
+}
+
+// -----------------------------------------------------------------------------
+
+uint32_t stringKey(const std::string & str) {
+  uint32_t hash = 2166136261u;
+  for (const char & c : str) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t locationKey(const atlas::Point3 & point) {
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t jj = 0; jj < 3; ++jj) {
+    // Same key for -0.0 and 0.0
+    const double value = point[jj]+0.0;
+    unsigned char bytes[sizeof(double)];
+    std::memcpy(bytes, &value, sizeof(double));
+    for (const auto & byte : bytes) {
+      hash ^= byte;
+      hash *= 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+// -----------------------------------------------------------------------------
+
+int columnDirection(const double * column,
+                    const size_t & nlevs) {
+  const bool increasing = column[0] <= column[nlevs-1];
+  for (size_t k = 0; k < nlevs-1; ++k) {
+    if ((column[k] < column[k+1]) != increasing && column[k] != column[k+1]) {
+      return 0;
+    }
+  }
+  return increasing ? 1 : -1;
+}
+
+// -----------------------------------------------------------------------------
+
+bool verticalStencil(const double * column,
+                     const size_t & nlevs,
+                     const int & direction,
+                     const double & z,
+                     std::array<size_t, 2> & stencil,
+                     std::array<double, 2> & weights,
+                     size_t & stencilSize) {
+  // Binary search only between bracketing end levels, the bisection keeping a valid bracket
+  const bool increasing = (direction > 0);
+  const double bottom = increasing ? column[0] : column[nlevs-1];
+  const double top = increasing ? column[nlevs-1] : column[0];
+  const bool search = (direction != 0) && (z >= bottom) && (z <= top);
+
+  size_t kinf = 0;
+  size_t ksup = 0;
+  if (search) {
+    // Binary search of the bracketing levels
+    size_t klo = 0;
+    size_t khi = nlevs-1;
+    while (khi-klo > 1) {
+      const size_t kmid = (klo+khi)/2;
+      if ((column[kmid] <= z) == increasing) {
+        klo = kmid;
+      } else {
+        khi = kmid;
+      }
+    }
+    if (column[klo] == z) {
+      kinf = klo;
+      ksup = klo;
+    } else if (column[khi] == z) {
+      kinf = khi;
+      ksup = khi;
+    } else {
+      kinf = increasing ? klo : khi;
+      ksup = increasing ? khi : klo;
+    }
+  } else {
+    // Full scan for non-monotonic columns, or heights outside of the end levels
+    double bottom = std::numeric_limits<double>::max();
+    double top = -std::numeric_limits<double>::max();
+    for (size_t k = 0; k < nlevs; ++k) {
+      bottom = std::min(bottom, column[k]);
+      top = std::max(top, column[k]);
+    }
+    if (z < bottom || z > top) {
+      return false;
+    }
+    double zinf = -std::numeric_limits<double>::max();
+    double zsup = std::numeric_limits<double>::max();
+    ksup = std::numeric_limits<size_t>::max();
+    for (size_t k = 0; k < nlevs; ++k) {
+      const double level = column[k];
+      if (level == z) {
+        zinf = level;
+        zsup = level;
+        kinf = k;
+        ksup = k;
+      } else {
+        if (z > level && zinf < level) {
+          zinf = level;
+          kinf = k;
+        }
+        if (z < level && zsup > level) {
+          zsup = level;
+          ksup = k;
+        }
+      }
+    }
+  }
+
+  // Stencil and weights
+  if (kinf == ksup) {
+    stencil[0] = kinf;
+    weights[0] = 1.0;
+    stencilSize = 1;
+  } else {
+    const double zinf = column[kinf];
+    const double zsup = column[ksup];
+    stencil[0] = kinf;
+    weights[0] = (zsup-z)/(zsup-zinf);
+    stencil[1] = ksup;
+    weights[1] = (z-zinf)/(zsup-zinf);
+    stencilSize = 2;
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+
 }  // namespace quenchxx
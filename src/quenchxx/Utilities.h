@@ -5,22 +5,57 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "atlas/field.h"
+#include "atlas/util/Point.h"
 
+#include "eckit/exception/Exceptions.h"
 #include "eckit/mpi/Comm.h"
 
 namespace quenchxx {
 
 // -----------------------------------------------------------------------------
 
+/// Call a generic functor with a value of the field storage type (float or double)
+template <typename Functor>
+void visitFieldStorage(const atlas::Field & field,
+                       const Functor & functor) {
+  if (field.datatype().kind() == atlas::array::DataType::kind<double>()) {
+    functor(double());
+  } else if (field.datatype().kind() == atlas::array::DataType::kind<float>()) {
+    functor(float());
+  } else {
+    throw eckit::NotImplemented("visitFieldStorage: unsupported datatype "
+      + field.datatype().str(), Here());
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void copyFieldData(const atlas::Field &,
+                   atlas::Field &);
+
+// -----------------------------------------------------------------------------
+
+atlas::FieldSet copyFieldSetToDouble(const atlas::FieldSet &);
+
+// -----------------------------------------------------------------------------
+
 void copyFieldSetWithoutFunctionSpace(const atlas::FieldSet &,
                                       atlas::FieldSet &);
 
 // -----------------------------------------------------------------------------
 
+double localDotProductFieldSetsWithoutFunctionSpace(const atlas::FieldSet &,
+                                                    const atlas::FieldSet &,
+                                                    const std::vector<std::string> &);
+
+// -----------------------------------------------------------------------------
+
 double dotProductFieldSetsWithoutFunctionSpace(const atlas::FieldSet &,
                                                const atlas::FieldSet &,
                                                const std::vector<std::string> &,
@@ -28,4 +63,52 @@ double dotProductFieldSetsWithoutFunctionSpace(const atlas::FieldSet &,
 
 // -----------------------------------------------------------------------------
 
+std::vector<double> dotProductsFieldSetsWithoutFunctionSpace(
+  const atlas::FieldSet &,
+  const std::vector<const atlas::FieldSet*> &,
+  const std::vector<std::string> &,
+  const eckit::mpi::Comm &);
+
+// -----------------------------------------------------------------------------
+
+/// Standard normal random number from a counter-based generator (Philox4x32-10): the value only
+/// depends on the seed and on the counter (global index, level, variable key), so that any
+/// decomposition of the counters across tasks and threads gives the same random field
+double counterBasedNormal(const uint64_t &,
+                          const uint64_t &,
+                          const uint32_t &,
+                          const uint32_t &);
+
+// -----------------------------------------------------------------------------
+
+/// 32-bit key of a string (FNV-1a hash), stable across tasks and runs
+uint32_t stringKey(const std::string &);
+
+// -----------------------------------------------------------------------------
+
+/// 64-bit key of an observation location (FNV-1a hash of the bit patterns of longitude, latitude
+/// and height): locations match only if they are bitwise identical, up to the sign of zero
+uint64_t locationKey(const atlas::Point3 &);
+
+// -----------------------------------------------------------------------------
+
+/// Direction of a vertical column: 1 if increasing, -1 if decreasing, 0 if not monotonic
+int columnDirection(const double *,
+                    const size_t &);
+
+// -----------------------------------------------------------------------------
+
+/// Linear vertical interpolation stencil (one or two levels) and weights at a given height in a
+/// column, with a binary search if the column direction is known (see columnDirection) and a
+/// linear scan otherwise, return false if outside of the column
+bool verticalStencil(const double *,
+                     const size_t &,
+                     const int &,
+                     const double &,
+                     std::array<size_t, 2> &,
+                     std::array<double, 2> &,
+                     size_t &);
+
+// -----------------------------------------------------------------------------
+
 }  // namespace quenchxx